@@ -0,0 +1,506 @@
+/*
+ * @file  DatasetGenerator.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include "DatasetGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+
+#ifdef VISIMPL_USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace simgen
+{
+  // Bytes buffered before every text write.
+  static const size_t WRITE_BUFFER_SIZE = 4 * 1024 * 1024;
+
+  // Salts separating the per-neuron streams used for each purpose.
+  static const uint64_t SALT_ACTIVITY = 0x5350494B45530000ULL;
+  static const uint64_t SALT_POSITION = 0x504F534954494F4EULL;
+  static const uint64_t SALT_EVENTS = 0x4556454E54530000ULL;
+  static const uint64_t SALT_SYNC = 0x53594E4353000000ULL;
+
+  // Splitmix64, fully specified so the output does not depend on the
+  // standard library implementation.
+  static inline uint64_t nextRandom( uint64_t& state )
+  {
+    uint64_t z = ( state += 0x9E3779B97F4A7C15ULL );
+    z = ( z ^ ( z >> 30 )) * 0xBF58476D1CE4E5B9ULL;
+    z = ( z ^ ( z >> 27 )) * 0x94D049BB133111EBULL;
+    return z ^ ( z >> 31 );
+  }
+
+  static inline uint64_t seedState( uint64_t seed, uint64_t salt,
+                                    uint64_t index )
+  {
+    uint64_t state = seed ^ salt;
+    nextRandom( state );
+    state ^= index * 0xD6E8FEB86659FD93ULL;
+    nextRandom( state );
+    return state;
+  }
+
+  // Uniform in [ 0, 1 ).
+  static inline double uniform( uint64_t& state )
+  {
+    return ( nextRandom( state ) >> 11 ) * ( 1.0 / 9007199254740992.0 );
+  }
+
+  static inline double exponential( uint64_t& state, double rate )
+  {
+    if( rate <= 0.0 )
+      return std::numeric_limits< double >::infinity( );
+
+    return -std::log( 1.0 - uniform( state )) / rate;
+  }
+
+  static inline double gaussian( uint64_t& state )
+  {
+    double u = 1.0 - uniform( state );
+    double v = uniform( state );
+    return std::sqrt( -2.0 * std::log( u )) *
+        std::cos( 2.0 * 3.14159265358979323846 * v );
+  }
+
+  /*
+   * Buffered text output.
+   */
+  class TextWriter
+  {
+  public:
+
+    TextWriter( const std::string& fileName )
+    : _fileName( fileName )
+    , _file( std::fopen( fileName.c_str( ), "wb" ))
+    {
+      if( !_file )
+        std::cerr << "Could not open " << fileName << " for writing."
+                  << std::endl;
+
+      _buffer.reserve( WRITE_BUFFER_SIZE + 256 );
+    }
+
+    ~TextWriter( void )
+    {
+      flush( );
+      if( _file )
+        std::fclose( _file );
+    }
+
+    bool valid( void ) const
+    {
+      return _file != nullptr;
+    }
+
+    void write( const char* text, size_t size )
+    {
+      _buffer.insert( _buffer.end( ), text, text + size );
+      if( _buffer.size( ) >= WRITE_BUFFER_SIZE )
+        flush( );
+    }
+
+    void write( const std::string& text )
+    {
+      write( text.data( ), text.size( ));
+    }
+
+    template< typename ... TArgs >
+    void print( const char* format, TArgs ... args )
+    {
+      char line[ 256 ];
+      int size = std::snprintf( line, sizeof( line ), format, args ... );
+      if( size > 0 )
+        write( line, std::min( size_t( size ), sizeof( line ) - 1 ));
+    }
+
+    void flush( void )
+    {
+      if( _file && !_buffer.empty( ))
+        std::fwrite( _buffer.data( ), 1, _buffer.size( ), _file );
+      _buffer.clear( );
+    }
+
+  protected:
+
+    std::string _fileName;
+    FILE* _file;
+    std::vector< char > _buffer;
+  };
+
+  GeneratorConfig::GeneratorConfig( void )
+  : seed( 0 )
+  , outputPrefix( "synthetic" )
+  , neurons( 10000 )
+  , subsets( 8 )
+  , events( 4 )
+  , duration( 100.0f )
+  , rate( 1.0f )
+  , pattern( TPATTERN_POISSON )
+  , burstRate( 0.05f )
+  , burstLength( 0.5f )
+  , burstFactor( 20.0f )
+  , syncRate( 0.5f )
+  , syncFraction( 0.6f )
+  , syncJitter( 0.02f )
+  , window( 1.0f )
+  , writeCSV( true )
+  , writeJSON( true )
+  { }
+
+  DatasetGenerator::DatasetGenerator( const GeneratorConfig& config )
+  : _config( config )
+  , _spikesNumber( 0 )
+  {
+    _config.subsets = std::max( 1u, std::min( _config.subsets,
+                                              _config.neurons ));
+    _config.window = std::max( _config.window, 1e-3f );
+
+    _neuronsPerSubset =
+        ( _config.neurons + _config.subsets - 1 ) / _config.subsets;
+
+    // Rounding up the subset size may leave trailing subsets without
+    // neurons, drop them.
+    _config.subsets =
+        ( _config.neurons + _neuronsPerSubset - 1 ) / _neuronsPerSubset;
+
+    // Bursts raise the rate during part of the time, lower the quiet rate
+    // so the mean stays at the requested one.
+    _baseRate = _config.rate;
+    if( _config.pattern == TPATTERN_BURSTY && _config.burstRate > 0.0f )
+    {
+      double burstFraction = _config.burstLength /
+          ( _config.burstLength + 1.0 / _config.burstRate );
+      _baseRate /= 1.0 + burstFraction * ( _config.burstFactor - 1.0 );
+    }
+  }
+
+  uint64_t DatasetGenerator::spikesNumber( void ) const
+  {
+    return _spikesNumber;
+  }
+
+  unsigned int DatasetGenerator::_subset( uint32_t gid ) const
+  {
+    return gid / _neuronsPerSubset;
+  }
+
+  bool DatasetGenerator::generate( void )
+  {
+    std::cout << "Generating " << _config.neurons << " neurons in "
+              << _config.subsets << " subsets, seed " << _config.seed
+              << std::endl;
+
+    _generateNetwork( );
+    _generateSyncEvents( );
+
+    if( _config.writeCSV && !_writeNetworkCSV( ))
+      return false;
+
+    // Positions are not needed anymore.
+    _positions.clear( );
+    _positions.shrink_to_fit( );
+
+    if( _config.writeCSV && !_writeActivity( ))
+      return false;
+
+    if( _config.writeJSON && !_writeSubsetsEvents( ))
+      return false;
+
+    std::cout << "Generated " << _spikesNumber << " spikes." << std::endl;
+
+    return true;
+  }
+
+  void DatasetGenerator::_generateNetwork( void )
+  {
+    const uint32_t neurons = _config.neurons;
+
+    // Subsets are gaussian clusters laid on a cubic grid.
+    unsigned int side = std::ceil( std::cbrt( double( _config.subsets )));
+    const float spacing = 1000.0f / side;
+
+    _positions.resize( size_t( neurons ) * 3 );
+
+  #ifdef VISIMPL_USE_OPENMP
+    #pragma omp parallel for
+  #endif
+    for( int64_t i = 0; i < ( int64_t ) neurons; ++i )
+    {
+      uint64_t state = seedState( _config.seed, SALT_POSITION, i );
+
+      unsigned int subset = _subset( i );
+      float center[ 3 ] = {( subset % side + 0.5f ) * spacing,
+                           (( subset / side ) % side + 0.5f ) * spacing,
+                           ( subset / ( side * side ) + 0.5f ) * spacing };
+
+      for( unsigned int c = 0; c < 3; ++c )
+        _positions[ i * 3 + c ] =
+            center[ c ] + gaussian( state ) * spacing * 0.15f;
+    }
+
+    _rngState.resize( neurons );
+    _nextSpikes.resize( neurons );
+    _nextSwitch.assign( neurons, std::numeric_limits< double >::infinity( ));
+    _bursting.assign( neurons, 0 );
+
+  #ifdef VISIMPL_USE_OPENMP
+    #pragma omp parallel for
+  #endif
+    for( int64_t i = 0; i < ( int64_t ) neurons; ++i )
+    {
+      _rngState[ i ] = seedState( _config.seed, SALT_ACTIVITY, i );
+
+      if( _config.pattern == TPATTERN_BURSTY )
+        _nextSwitch[ i ] = exponential( _rngState[ i ], _config.burstRate );
+
+      _nextSpikes[ i ] = _nextSpike( i, 0.0 );
+    }
+  }
+
+  void DatasetGenerator::_generateSyncEvents( void )
+  {
+    uint64_t state = seedState( _config.seed, SALT_EVENTS, 0 );
+
+    _syncEvents.clear( );
+
+    if( _config.pattern == TPATTERN_SYNCHRONIZED )
+    {
+      // Every subset gets its own event, active during each of its
+      // synchronized firings.
+      _eventFrames.assign( _config.subsets, std::vector< TTimeFrame >( ));
+
+      double time = 0.0;
+      while( true )
+      {
+        time += exponential( state, _config.syncRate );
+        if( time >= _config.duration )
+          break;
+
+        unsigned int subset = nextRandom( state ) % _config.subsets;
+        _syncEvents.emplace_back( time, subset );
+        _eventFrames[ subset ].emplace_back( time, time + _config.syncJitter );
+      }
+
+      return;
+    }
+
+    // Otherwise events are unrelated to activity: a few random time frames
+    // each, covering about a tenth of the simulation.
+    _eventFrames.assign( _config.events, std::vector< TTimeFrame >( ));
+    for( auto& frames : _eventFrames )
+    {
+      unsigned int framesNumber = 1 + nextRandom( state ) % 8;
+      float length = _config.duration * 0.1f / framesNumber;
+
+      for( unsigned int i = 0; i < framesNumber; ++i )
+      {
+        float begin = uniform( state ) * ( _config.duration - length );
+        frames.emplace_back( begin, begin + length );
+      }
+
+      std::sort( frames.begin( ), frames.end( ));
+    }
+  }
+
+  double DatasetGenerator::_nextSpike( uint32_t neuron, double from )
+  {
+    uint64_t& state = _rngState[ neuron ];
+
+    if( _config.pattern != TPATTERN_BURSTY )
+      return from + exponential( state, _baseRate );
+
+    // Piecewise constant rate, resampled at every state switch (the
+    // exponential distribution is memoryless).
+    double time = from;
+    while( true )
+    {
+      bool bursting = _bursting[ neuron ];
+      double rate = bursting ? _baseRate * _config.burstFactor : _baseRate;
+
+      double candidate = time + exponential( state, rate );
+      if( candidate < _nextSwitch[ neuron ])
+        return candidate;
+
+      time = _nextSwitch[ neuron ];
+      if( time == std::numeric_limits< double >::infinity( ))
+        return time;
+
+      _bursting[ neuron ] = !bursting;
+      _nextSwitch[ neuron ] = time + ( bursting ?
+          exponential( state, _config.burstRate ) : _config.burstLength );
+    }
+  }
+
+  void DatasetGenerator::_fillWindow( double begin, double end,
+                                      TSpikes& spikes )
+  {
+    auto syncBegin = std::lower_bound(
+        _syncEvents.begin( ), _syncEvents.end( ),
+        std::make_pair( begin, 0u ));
+    auto syncEnd = std::lower_bound(
+        _syncEvents.begin( ), _syncEvents.end( ),
+        std::make_pair( end, 0u ));
+
+  #ifdef VISIMPL_USE_OPENMP
+    #pragma omp parallel
+  #endif
+    {
+      TSpikes local;
+
+    #ifdef VISIMPL_USE_OPENMP
+      #pragma omp for schedule( static )
+    #endif
+      for( int64_t i = 0; i < ( int64_t ) _config.neurons; ++i )
+      {
+        double time = _nextSpikes[ i ];
+        while( time < end )
+        {
+          local.emplace_back( time, i );
+          time = _nextSpike( i, time );
+        }
+        _nextSpikes[ i ] = time;
+
+        unsigned int subset = _subset( i );
+        for( auto sync = syncBegin; sync != syncEnd; ++sync )
+        {
+          if( sync->second != subset )
+            continue;
+
+          // Keyed by ( event, neuron ) so sync spikes do not depend on the
+          // window each event falls into.
+          uint64_t state = seedState(
+              seedState( _config.seed, SALT_SYNC, sync - _syncEvents.begin( )),
+              SALT_SYNC, i );
+          if( uniform( state ) < _config.syncFraction )
+            local.emplace_back(
+                sync->first + uniform( state ) * _config.syncJitter, i );
+        }
+      }
+
+    #ifdef VISIMPL_USE_OPENMP
+      #pragma omp critical
+    #endif
+      spikes.insert( spikes.end( ), local.begin( ), local.end( ));
+    }
+
+    // Total order, so the result does not depend on the thread schedule.
+    std::sort( spikes.begin( ), spikes.end( ));
+  }
+
+  bool DatasetGenerator::_writeNetworkCSV( void ) const
+  {
+    std::string fileName = _config.outputPrefix + "_network.csv";
+    TextWriter writer( fileName );
+    if( !writer.valid( ))
+      return false;
+
+    for( uint32_t i = 0; i < _config.neurons; ++i )
+      writer.print( "%u,%.3f,%.3f,%.3f\n", i, _positions[ i * 3 ],
+                    _positions[ i * 3 + 1 ], _positions[ i * 3 + 2 ]);
+
+    std::cout << "Written " << fileName << std::endl;
+
+    return true;
+  }
+
+  bool DatasetGenerator::_writeActivity( void )
+  {
+    TextWriter csv( _config.outputPrefix + "_activity.csv" );
+    if( !csv.valid( ))
+      return false;
+
+    TSpikes spikes;
+    TSpikes carry;
+
+    unsigned int lastPercentage = 0;
+
+    for( double begin = 0.0; begin < _config.duration;
+         begin += _config.window )
+    {
+      double end = std::min( begin + _config.window,
+                             double( _config.duration ));
+      bool lastWindow = end >= _config.duration;
+
+      spikes.swap( carry );
+      carry.clear( );
+
+      _fillWindow( begin, end, spikes );
+
+      // Synchronized spikes may fall after the window, keep them for the
+      // next one.
+      auto split = std::lower_bound( spikes.begin( ), spikes.end( ),
+                                     std::make_pair( float( end ), 0u ));
+      if( !lastWindow )
+        carry.assign( split, spikes.end( ));
+      spikes.erase( split, spikes.end( ));
+
+      for( const auto& spike : spikes )
+        csv.print( "%u,%.4f\n", spike.second, spike.first );
+
+      _spikesNumber += spikes.size( );
+      spikes.clear( );
+
+      unsigned int percentage = end * 100 / _config.duration;
+      if( percentage >= lastPercentage + 10 || lastWindow )
+      {
+        std::cout << "Activity " << percentage << "% ("
+                  << _spikesNumber << " spikes)" << std::endl;
+        lastPercentage = percentage;
+      }
+    }
+
+    return true;
+  }
+
+  bool DatasetGenerator::_writeSubsetsEvents( void ) const
+  {
+    std::string fileName = _config.outputPrefix + "_subsets_events.json";
+    TextWriter writer( fileName );
+    if( !writer.valid( ))
+      return false;
+
+    writer.write( "{\n  \"subsets\": [" );
+    for( unsigned int i = 0; i < _config.subsets; ++i )
+    {
+      uint32_t first = i * _neuronsPerSubset;
+      uint32_t last = std::min( first + _neuronsPerSubset, _config.neurons );
+
+      writer.print( "%s\n    { \"name\": \"subset_%u\", \"gids\": [",
+                    i == 0 ? "" : ",", i );
+      for( uint32_t gid = first; gid < last; ++gid )
+        writer.print( gid == first ? "%u" : ",%u", gid );
+      writer.write( "] }" );
+    }
+
+    const char* eventPrefix =
+        _config.pattern == TPATTERN_SYNCHRONIZED ? "sync" : "event";
+
+    writer.write( "\n  ],\n  \"events\": [" );
+    for( unsigned int i = 0; i < _eventFrames.size( ); ++i )
+    {
+      writer.print( "%s\n    { \"name\": \"%s_%u\", \"timeFrames\": [",
+                    i == 0 ? "" : ",", eventPrefix, i );
+      for( unsigned int j = 0; j < _eventFrames[ i ].size( ); ++j )
+        writer.print( "%s[%.4f,%.4f]", j == 0 ? "" : ",",
+                      _eventFrames[ i ][ j ].first,
+                      _eventFrames[ i ][ j ].second );
+      writer.write( "] }" );
+    }
+    writer.write( "\n  ]\n}\n" );
+
+    std::cout << "Written " << fileName << std::endl;
+
+    return true;
+  }
+
+}
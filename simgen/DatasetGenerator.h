@@ -0,0 +1,121 @@
+/*
+ * @file  DatasetGenerator.h
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+#ifndef __SIMGEN_DATASETGENERATOR__
+#define __SIMGEN_DATASETGENERATOR__
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace simgen
+{
+  typedef enum
+  {
+    TPATTERN_POISSON = 0,
+    TPATTERN_BURSTY,
+    TPATTERN_SYNCHRONIZED
+  } TFiringPattern;
+
+  typedef std::pair< float, uint32_t > TSpike;
+  typedef std::vector< TSpike > TSpikes;
+
+  struct GeneratorConfig
+  {
+    GeneratorConfig( void );
+
+    uint64_t seed;
+    std::string outputPrefix;
+
+    uint32_t neurons;
+    unsigned int subsets;
+    unsigned int events;
+
+    // Simulation time units.
+    float duration;
+    // Mean spikes per neuron and time unit.
+    float rate;
+
+    TFiringPattern pattern;
+
+    // Bursty: bursts start at burstRate per neuron and time unit, last
+    // burstLength and multiply the firing rate by burstFactor.
+    float burstRate;
+    float burstLength;
+    float burstFactor;
+
+    // Synchronized: every sync event drives syncFraction of one subset
+    // to fire within syncJitter after the event.
+    float syncRate;
+    float syncFraction;
+    float syncJitter;
+
+    // Time span generated and flushed at once.
+    float window;
+
+    bool writeCSV;
+    bool writeJSON;
+  };
+
+  /*
+   * Writes reproducible synthetic datasets: CSV network/activity pair and a
+   * subset/events JSON file. Every neuron draws from its own generator
+   * seeded by ( seed, gid ) and synchronized firings from one seeded by
+   * ( seed, event, gid ), so the output only depends on the configuration,
+   * not on the number of threads nor the window size. Activity is produced
+   * window by window in time order, so datasets larger than memory
+   * can be written.
+   */
+  class DatasetGenerator
+  {
+  public:
+
+    DatasetGenerator( const GeneratorConfig& config );
+
+    bool generate( void );
+
+    uint64_t spikesNumber( void ) const;
+
+  protected:
+
+    typedef std::pair< float, float > TTimeFrame;
+
+    void _generateNetwork( void );
+    void _generateSyncEvents( void );
+
+    void _fillWindow( double begin, double end, TSpikes& spikes );
+    double _nextSpike( uint32_t neuron, double from );
+
+    bool _writeNetworkCSV( void ) const;
+    bool _writeActivity( void );
+    bool _writeSubsetsEvents( void ) const;
+
+    unsigned int _subset( uint32_t gid ) const;
+
+    GeneratorConfig _config;
+
+    uint32_t _neuronsPerSubset;
+    double _baseRate;
+
+    std::vector< float > _positions;
+
+    std::vector< uint64_t > _rngState;
+    std::vector< double > _nextSpikes;
+    std::vector< double > _nextSwitch;
+    std::vector< uint8_t > _bursting;
+
+    std::vector< std::pair< double, unsigned int >> _syncEvents;
+    std::vector< std::vector< TTimeFrame >> _eventFrames;
+
+    uint64_t _spikesNumber;
+  };
+
+}
+
+#endif /* __SIMGEN_DATASETGENERATOR__ */
@@ -0,0 +1,188 @@
+/*
+ * @file  simgen.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "DatasetGenerator.h"
+
+void usageMessage( char* progName, int exitCode = -1 );
+
+int main( int argc, char** argv )
+{
+  simgen::GeneratorConfig config;
+  double totalSpikes = 0.0;
+
+  for( int i = 1; i < argc; i++ )
+  {
+    if ( std::strcmp( argv[i], "--help" ) == 0 ||
+         std::strcmp( argv[i], "-h" ) == 0 )
+    {
+      usageMessage( argv[0], 0 );
+    }
+    else if( std::strcmp( argv[ i ], "-o" ) == 0 )
+    {
+      if( ++i < argc )
+        config.outputPrefix = argv[ i ];
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-seed" ) == 0 )
+    {
+      if( ++i < argc )
+        config.seed = std::strtoull( argv[ i ], nullptr, 10 );
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-neurons" ) == 0 )
+    {
+      if( ++i < argc )
+        config.neurons = std::strtoul( argv[ i ], nullptr, 10 );
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-spikes" ) == 0 )
+    {
+      if( ++i < argc )
+        totalSpikes = std::atof( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-rate" ) == 0 )
+    {
+      if( ++i < argc )
+        config.rate = std::atof( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-duration" ) == 0 )
+    {
+      if( ++i < argc )
+        config.duration = std::atof( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-subsets" ) == 0 )
+    {
+      if( ++i < argc )
+        config.subsets = std::atoi( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-events" ) == 0 )
+    {
+      if( ++i < argc )
+        config.events = std::atoi( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-window" ) == 0 )
+    {
+      if( ++i < argc )
+        config.window = std::atof( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-pattern" ) == 0 )
+    {
+      if( ++i >= argc )
+        usageMessage( argv[0] );
+
+      if( std::strcmp( argv[ i ], "poisson" ) == 0 )
+        config.pattern = simgen::TPATTERN_POISSON;
+      else if( std::strcmp( argv[ i ], "bursty" ) == 0 )
+        config.pattern = simgen::TPATTERN_BURSTY;
+      else if( std::strcmp( argv[ i ], "sync" ) == 0 )
+        config.pattern = simgen::TPATTERN_SYNCHRONIZED;
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-burst" ) == 0 )
+    {
+      if( i + 3 < argc )
+      {
+        config.burstRate = std::atof( argv[ ++i ]);
+        config.burstLength = std::atof( argv[ ++i ]);
+        config.burstFactor = std::atof( argv[ ++i ]);
+      }
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-sync" ) == 0 )
+    {
+      if( i + 3 < argc )
+      {
+        config.syncRate = std::atof( argv[ ++i ]);
+        config.syncFraction = std::atof( argv[ ++i ]);
+        config.syncJitter = std::atof( argv[ ++i ]);
+      }
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-no-csv" ) == 0 )
+    {
+      config.writeCSV = false;
+    }
+    else if( std::strcmp( argv[ i ], "-no-json" ) == 0 )
+    {
+      config.writeJSON = false;
+    }
+    else
+    {
+      std::cerr << "Unknown option " << argv[ i ] << std::endl;
+      usageMessage( argv[0] );
+    }
+  }
+
+  if( config.neurons == 0 || config.duration <= 0.0f )
+    usageMessage( argv[0] );
+
+  // Spike count requests are turned into the equivalent mean rate.
+  if( totalSpikes > 0.0 )
+    config.rate = totalSpikes / ( double( config.neurons ) * config.duration );
+
+  simgen::DatasetGenerator generator( config );
+
+  return generator.generate( ) ? 0 : -1;
+}
+
+void usageMessage( char* progName, int exitCode )
+{
+  std::cerr << std::endl
+            << "Usage: "
+            << progName << std::endl
+            << "\t[ -o <output_prefix> ]"
+            << std::endl
+            << "\t[ -seed <seed> ]"
+            << std::endl
+            << "\t[ -neurons <neurons> ]"
+            << std::endl
+            << "\t[ -spikes <total_spikes> | -rate <spikes_per_neuron_and_time> ]"
+            << std::endl
+            << "\t[ -duration <time> ]"
+            << std::endl
+            << "\t[ -pattern poisson | bursty | sync ]"
+            << std::endl
+            << "\t[ -burst <burst_rate> <burst_length> <burst_factor> ]"
+            << std::endl
+            << "\t[ -sync <sync_rate> <sync_fraction> <sync_jitter> ]"
+            << std::endl
+            << "\t[ -subsets <subsets> ]"
+            << std::endl
+            << "\t[ -events <events> ]"
+            << std::endl
+            << "\t[ -window <time> ]"
+            << std::endl
+            << "\t[ -no-csv ] [ -no-json ]"
+            << std::endl
+            << "\t[ --help | -h ]"
+            << std::endl << std::endl;
+  exit( exitCode );
+}
@@ -0,0 +1,530 @@
+/*
+ * @file  ReplayServer.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include "ReplayServer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace simrest
+{
+  // Largest request accepted, only GET requests are served.
+  static const size_t MAX_REQUEST = 16 * 1024;
+
+  static TQuery parseQuery( const std::string& query )
+  {
+    TQuery result;
+
+    size_t begin = 0;
+    while( begin < query.size( ))
+    {
+      size_t end = query.find( '&', begin );
+      if( end == std::string::npos )
+        end = query.size( );
+
+      std::string pair = query.substr( begin, end - begin );
+      size_t equal = pair.find( '=' );
+      if( equal != std::string::npos )
+        result[ pair.substr( 0, equal )] = pair.substr( equal + 1 );
+      else if( !pair.empty( ))
+        result[ pair ] = "";
+
+      begin = end + 1;
+    }
+
+    return result;
+  }
+
+  // Comma separated gids, also accepting the URL encoded comma.
+  static std::set< uint32_t > parseGids( const std::string& value )
+  {
+    std::set< uint32_t > result;
+
+    const char* it = value.c_str( );
+    while( *it )
+    {
+      if( std::isdigit( *it ))
+      {
+        char* end;
+        result.insert( std::strtoul( it, &end, 10 ));
+        it = end;
+      }
+      else
+      {
+        ++it;
+      }
+    }
+
+    return result;
+  }
+
+  static bool queryFloat( const TQuery& query, const std::string& key,
+                          float& value )
+  {
+    auto it = query.find( key );
+    if( it == query.end( ) || it->second.empty( ))
+      return false;
+
+    value = std::strtof( it->second.c_str( ), nullptr );
+    return true;
+  }
+
+  static size_t querySize( const TQuery& query, const std::string& key,
+                           size_t defaultValue )
+  {
+    auto it = query.find( key );
+    if( it == query.end( ) || it->second.empty( ))
+      return defaultValue;
+
+    return std::strtoull( it->second.c_str( ), nullptr, 10 );
+  }
+
+  static void appendFloat( std::string& out, float value )
+  {
+    char buffer[ 32 ];
+    std::snprintf( buffer, sizeof( buffer ), "%.4f", value );
+    out += buffer;
+  }
+
+  static bool sendAll( int socket_, const std::string& data )
+  {
+    size_t sent = 0;
+    while( sent < data.size( ))
+    {
+      ssize_t result = ::send( socket_, data.data( ) + sent,
+                               data.size( ) - sent, 0 );
+      if( result < 0 && errno == EINTR )
+        continue;
+      if( result <= 0 )
+        return false;
+
+      sent += result;
+    }
+
+    return true;
+  }
+
+  ReplayConfig::ReplayConfig( void )
+  : port( 8080 )
+  , speed( 1.0f )
+  , stepSize( 0.1f )
+  , grow( false )
+  { }
+
+  ReplayServer::ReplayServer( const ReplayConfig& config )
+  : _config( config )
+  , _startTime( 0.0f )
+  , _endTime( 0.0f )
+  , _started( false )
+  , _socket( -1 )
+  { }
+
+  ReplayServer::~ReplayServer( void )
+  {
+    if( _socket >= 0 )
+      ::close( _socket );
+  }
+
+  bool ReplayServer::load( void )
+  {
+    if( !_loadNetwork( ) || !_loadActivity( ))
+      return false;
+
+    std::cout << "Replaying " << _gids.size( ) << " neurons and "
+              << _spikes.size( ) << " spikes in [ " << _startTime << ", "
+              << _endTime << " ]" << std::endl;
+
+    return true;
+  }
+
+  bool ReplayServer::_loadNetwork( void )
+  {
+    std::ifstream file( _config.networkFile );
+    if( !file )
+    {
+      std::cerr << "Could not open network file " << _config.networkFile
+                << std::endl;
+      return false;
+    }
+
+    std::vector< std::pair< uint32_t, std::vector< float >>> neurons;
+
+    // Lines not starting with a number (headers, comments) are skipped.
+    std::string line;
+    while( std::getline( file, line ))
+    {
+      if( line.empty( ) || !std::isdigit( line[ 0 ]))
+        continue;
+
+      for( auto& c : line )
+        if( c == ';' || c == '\t' )
+          c = ',';
+
+      unsigned int gid;
+      float x, y, z;
+      if( std::sscanf( line.c_str( ), "%u , %f , %f , %f", &gid, &x, &y, &z )
+          == 4 )
+        neurons.push_back( std::make_pair( gid,
+                                           std::vector< float >{ x, y, z }));
+    }
+
+    std::sort( neurons.begin( ), neurons.end( ),
+               []( const std::pair< uint32_t, std::vector< float >>& a,
+                   const std::pair< uint32_t, std::vector< float >>& b )
+               { return a.first < b.first; });
+
+    for( const auto& neuron : neurons )
+    {
+      if( !_gids.empty( ) && _gids.back( ) == neuron.first )
+        continue;
+
+      _gids.push_back( neuron.first );
+      _positions.insert( _positions.end( ), neuron.second.begin( ),
+                         neuron.second.end( ));
+    }
+
+    if( _gids.empty( ))
+    {
+      std::cerr << "No neurons found in " << _config.networkFile
+                << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  bool ReplayServer::_loadActivity( void )
+  {
+    std::ifstream file( _config.activityFile );
+    if( !file )
+    {
+      std::cerr << "Could not open activity file " << _config.activityFile
+                << std::endl;
+      return false;
+    }
+
+    std::string line;
+    while( std::getline( file, line ))
+    {
+      if( line.empty( ) || !std::isdigit( line[ 0 ]))
+        continue;
+
+      for( auto& c : line )
+        if( c == ';' || c == '\t' )
+          c = ',';
+
+      unsigned int gid;
+      float time;
+      if( std::sscanf( line.c_str( ), "%u , %f", &gid, &time ) == 2 &&
+          std::binary_search( _gids.begin( ), _gids.end( ), gid ))
+        _spikes.emplace_back( time, gid );
+    }
+
+    std::stable_sort( _spikes.begin( ), _spikes.end( ),
+                      []( const TSpike& a, const TSpike& b )
+                      { return a.first < b.first; });
+
+    _startTime = _spikes.empty( ) ? 0.0f :
+        std::min( 0.0f, _spikes.front( ).first );
+    _endTime = _spikes.empty( ) ? 0.0f : _spikes.back( ).first;
+
+    return true;
+  }
+
+  float ReplayServer::_currentTime( void )
+  {
+    // The replay starts with the first request, clients see it all.
+    if( !_started )
+    {
+      _start = std::chrono::steady_clock::now( );
+      _started = true;
+    }
+
+    std::chrono::duration< double > elapsed =
+        std::chrono::steady_clock::now( ) - _start;
+
+    return std::min( _endTime, float( _startTime +
+                                      elapsed.count( ) * _config.speed ));
+  }
+
+  size_t ReplayServer::_published( float time ) const
+  {
+    if( !_config.grow || _endTime <= _startTime )
+      return _gids.size( );
+
+    double fraction = ( time - _startTime ) / ( _endTime - _startTime );
+
+    return std::max( size_t( 1 ), std::min( _gids.size( ),
+        size_t( std::ceil( fraction * _gids.size( )))));
+  }
+
+  bool ReplayServer::_isPublished( uint32_t gid, size_t published ) const
+  {
+    return published > 0 && gid <= _gids[ published - 1 ];
+  }
+
+  bool ReplayServer::run( void )
+  {
+    // Clients closing early must not kill the server.
+    std::signal( SIGPIPE, SIG_IGN );
+
+    _socket = ::socket( AF_INET, SOCK_STREAM, 0 );
+    if( _socket < 0 )
+    {
+      std::cerr << "Could not create socket: " << std::strerror( errno )
+                << std::endl;
+      return false;
+    }
+
+    int reuse = 1;
+    ::setsockopt( _socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof( reuse ));
+
+    sockaddr_in address;
+    std::memset( &address, 0, sizeof( address ));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl( INADDR_ANY );
+    address.sin_port = htons( _config.port );
+
+    if( ::bind( _socket, reinterpret_cast< sockaddr* >( &address ),
+                sizeof( address )) < 0 ||
+        ::listen( _socket, 16 ) < 0 )
+    {
+      std::cerr << "Could not listen on port " << _config.port << ": "
+                << std::strerror( errno ) << std::endl;
+      return false;
+    }
+
+    std::cout << "Listening on port " << _config.port << std::endl;
+
+    while( true )
+    {
+      int client = ::accept( _socket, nullptr, nullptr );
+      if( client < 0 )
+      {
+        if( errno == EINTR )
+          continue;
+
+        std::cerr << "Accept failed: " << std::strerror( errno ) << std::endl;
+        return false;
+      }
+
+      _serve( client );
+      ::close( client );
+    }
+
+    return true;
+  }
+
+  void ReplayServer::_serve( int client )
+  {
+    std::string request;
+    char buffer[ 4096 ];
+
+    while( request.find( "\r\n\r\n" ) == std::string::npos &&
+           request.size( ) < MAX_REQUEST )
+    {
+      ssize_t received = ::recv( client, buffer, sizeof( buffer ), 0 );
+      if( received < 0 && errno == EINTR )
+        continue;
+      if( received <= 0 )
+        break;
+
+      request.append( buffer, received );
+    }
+
+    std::string status = "200 OK";
+    std::string body;
+
+    size_t methodEnd = request.find( ' ' );
+    size_t targetEnd = request.find( ' ', methodEnd + 1 );
+
+    if( methodEnd == std::string::npos || targetEnd == std::string::npos )
+    {
+      status = "400 Bad Request";
+      body = "{\"error\":\"malformed request\"}";
+    }
+    else if( request.compare( 0, methodEnd, "GET" ) != 0 )
+    {
+      status = "405 Method Not Allowed";
+      body = "{\"error\":\"only GET is supported\"}";
+    }
+    else if( !_respond( request.substr( methodEnd + 1,
+                                        targetEnd - methodEnd - 1 ), body ))
+    {
+      status = "404 Not Found";
+      body = "{\"error\":\"unknown endpoint\"}";
+    }
+
+    std::string response = "HTTP/1.1 " + status + "\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: " + std::to_string( body.size( )) + "\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Connection: close\r\n\r\n" + body;
+
+    sendAll( client, response );
+  }
+
+  bool ReplayServer::_respond( const std::string& target, std::string& body )
+  {
+    size_t separator = target.find( '?' );
+    std::string path = target.substr( 0, separator );
+    TQuery query = parseQuery( separator == std::string::npos ?
+                               std::string( ) :
+                               target.substr( separator + 1 ));
+
+    if( path.compare( 0, 5, "/nest" ) == 0 )
+      path = path.substr( 5 );
+
+    while( path.size( ) > 1 && path.back( ) == '/' )
+      path.pop_back( );
+
+    float time = _currentTime( );
+    size_t published = _published( time );
+
+    if( path == "/simulation_time_info" )
+      body = _simulationTimeInfo( time );
+    else if( path == "/gids" )
+      body = _gidsList( published );
+    else if( path == "/neuron_properties" )
+      body = _neuronProperties( query, published );
+    else if( path == "/spikes" )
+      body = _spikesBetween( query, time, published );
+    else
+      return false;
+
+    return true;
+  }
+
+  std::string ReplayServer::_simulationTimeInfo( float time ) const
+  {
+    std::string result = "{\"begin\":";
+    appendFloat( result, _startTime );
+    result += ",\"current\":";
+    appendFloat( result, time );
+    result += ",\"end\":";
+    appendFloat( result, _endTime );
+    result += ",\"step_size\":";
+    appendFloat( result, _config.stepSize );
+    result += "}";
+
+    return result;
+  }
+
+  std::string ReplayServer::_gidsList( size_t published ) const
+  {
+    std::string result = "[";
+    for( size_t i = 0; i < published; ++i )
+    {
+      if( i > 0 )
+        result += ",";
+      result += std::to_string( _gids[ i ]);
+    }
+    result += "]";
+
+    return result;
+  }
+
+  std::string ReplayServer::_neuronProperties( const TQuery& query,
+                                               size_t published ) const
+  {
+    auto filter = query.find( "gids" );
+    std::set< uint32_t > gids;
+    if( filter != query.end( ))
+      gids = parseGids( filter->second );
+
+    std::string result = "[";
+    bool first = true;
+
+    for( size_t i = 0; i < published; ++i )
+    {
+      if( !gids.empty( ) && gids.find( _gids[ i ]) == gids.end( ))
+        continue;
+
+      if( !first )
+        result += ",";
+      first = false;
+
+      result += "{\"gid\":" + std::to_string( _gids[ i ]) +
+          ",\"properties\":{\"position\":[";
+      appendFloat( result, _positions[ i * 3 ]);
+      result += ",";
+      appendFloat( result, _positions[ i * 3 + 1 ]);
+      result += ",";
+      appendFloat( result, _positions[ i * 3 + 2 ]);
+      result += "]}}";
+    }
+    result += "]";
+
+    return result;
+  }
+
+  std::string ReplayServer::_spikesBetween( const TQuery& query, float time,
+                                            size_t published ) const
+  {
+    float fromTime = _startTime;
+    float toTime = time;
+    queryFloat( query, "fromTime", fromTime );
+    queryFloat( query, "toTime", toTime );
+    toTime = std::min( toTime, time );
+
+    size_t offset = querySize( query, "offset", 0 );
+    size_t limit = querySize( query, "limit", _spikes.size( ));
+
+    auto filter = query.find( "gids" );
+    std::set< uint32_t > gids;
+    if( filter != query.end( ))
+      gids = parseGids( filter->second );
+
+    auto spike = std::lower_bound( _spikes.begin( ), _spikes.end( ), fromTime,
+                                   []( const TSpike& s, float value )
+                                   { return s.first < value; });
+
+    std::string times = "[";
+    std::string spikeGids = "[";
+    size_t matched = 0;
+    size_t written = 0;
+
+    for( ; spike != _spikes.end( ) && spike->first < toTime &&
+           written < limit; ++spike )
+    {
+      if( !_isPublished( spike->second, published ) ||
+          ( !gids.empty( ) && gids.find( spike->second ) == gids.end( )))
+        continue;
+
+      if( matched++ < offset )
+        continue;
+
+      if( written++ > 0 )
+      {
+        times += ",";
+        spikeGids += ",";
+      }
+
+      appendFloat( times, spike->first );
+      spikeGids += std::to_string( spike->second );
+    }
+
+    return "{\"simulation_times\":" + times + "],\"gids\":" + spikeGids +
+        "]}";
+  }
+
+}
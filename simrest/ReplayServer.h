@@ -0,0 +1,109 @@
+/*
+ * @file  ReplayServer.h
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+#ifndef __SIMREST_REPLAYSERVER__
+#define __SIMREST_REPLAYSERVER__
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace simrest
+{
+  typedef std::pair< float, uint32_t > TSpike;
+  typedef std::vector< TSpike > TSpikes;
+
+  typedef std::map< std::string, std::string > TQuery;
+
+  struct ReplayConfig
+  {
+    ReplayConfig( void );
+
+    std::string networkFile;
+    std::string activityFile;
+
+    unsigned short port;
+
+    // Simulation time units replayed per second.
+    float speed;
+    float stepSize;
+
+    // Neurons are published in gid order as the replay advances, so
+    // clients see the network grow instead of complete from the start.
+    bool grow;
+  };
+
+  /*
+   * Stand-in for the simulation REST server. A recorded simulation, a CSV
+   * network ( "gid,x,y,z" ) and activity ( "gid,time" ) pair as written by
+   * simgen, is replayed on the wall clock from the first request on and
+   * served through the same endpoints the REST loader polls:
+   *
+   *   /simulation_time_info                       begin, current and end
+   *   /gids                                       published gids
+   *   /neuron_properties[?gids=a,b]               gids and positions
+   *   /spikes?fromTime=t0&toTime=t1[&gids=a,b]    spikes in [ t0, t1 )
+   *           [&offset=n][&limit=n]
+   *
+   * Paths may also be prefixed by /nest. Spikes are never served ahead of
+   * the current replay time nor for unpublished neurons.
+   */
+  class ReplayServer
+  {
+  public:
+
+    ReplayServer( const ReplayConfig& config );
+    ~ReplayServer( void );
+
+    bool load( void );
+
+    // Serves requests until the process is stopped.
+    bool run( void );
+
+  protected:
+
+    bool _loadNetwork( void );
+    bool _loadActivity( void );
+
+    float _currentTime( void );
+    size_t _published( float time ) const;
+    bool _isPublished( uint32_t gid, size_t published ) const;
+
+    void _serve( int client );
+    bool _respond( const std::string& target, std::string& body );
+
+    std::string _simulationTimeInfo( float time ) const;
+    std::string _gidsList( size_t published ) const;
+    std::string _neuronProperties( const TQuery& query,
+                                   size_t published ) const;
+    std::string _spikesBetween( const TQuery& query, float time,
+                                size_t published ) const;
+
+    ReplayConfig _config;
+
+    // Ascending gids and their positions, three floats each.
+    std::vector< uint32_t > _gids;
+    std::vector< float > _positions;
+
+    // Sorted by time.
+    TSpikes _spikes;
+    float _startTime;
+    float _endTime;
+
+    bool _started;
+    std::chrono::steady_clock::time_point _start;
+
+    int _socket;
+  };
+
+}
+
+#endif /* __SIMREST_REPLAYSERVER__ */
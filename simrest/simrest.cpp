@@ -0,0 +1,100 @@
+/*
+ * @file  simrest.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "ReplayServer.h"
+
+void usageMessage( char* progName, int exitCode = -1 );
+
+int main( int argc, char** argv )
+{
+  simrest::ReplayConfig config;
+
+  for( int i = 1; i < argc; i++ )
+  {
+    if ( std::strcmp( argv[i], "--help" ) == 0 ||
+         std::strcmp( argv[i], "-h" ) == 0 )
+    {
+      usageMessage( argv[0], 0 );
+    }
+    else if( std::strcmp( argv[ i ], "-csv" ) == 0 )
+    {
+      if( i + 2 < argc )
+      {
+        config.networkFile = argv[ ++i ];
+        config.activityFile = argv[ ++i ];
+      }
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-port" ) == 0 )
+    {
+      if( ++i < argc )
+        config.port = std::atoi( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-speed" ) == 0 )
+    {
+      if( ++i < argc )
+        config.speed = std::atof( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-step" ) == 0 )
+    {
+      if( ++i < argc )
+        config.stepSize = std::atof( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-grow" ) == 0 )
+    {
+      config.grow = true;
+    }
+    else
+    {
+      std::cerr << "Unknown option " << argv[ i ] << std::endl;
+      usageMessage( argv[0] );
+    }
+  }
+
+  if( config.networkFile.empty( ) || config.speed <= 0.0f )
+    usageMessage( argv[0] );
+
+  simrest::ReplayServer server( config );
+
+  if( !server.load( ))
+    return -1;
+
+  return server.run( ) ? 0 : -1;
+}
+
+void usageMessage( char* progName, int exitCode )
+{
+  std::cerr << std::endl
+            << "Usage: "
+            << progName << std::endl
+            << "\t-csv <network_file> <activity_file>"
+            << std::endl
+            << "\t[ -port <port> ]"
+            << std::endl
+            << "\t[ -speed <time_per_second> ]"
+            << std::endl
+            << "\t[ -step <step_size> ]"
+            << std::endl
+            << "\t[ -grow ]"
+            << std::endl
+            << "\t[ --help | -h ]"
+            << std::endl << std::endl;
+  exit( exitCode );
+}
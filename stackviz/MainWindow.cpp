@@ -166,9 +166,7 @@ namespace stackviz
      case simil::TSimSpikes:
      {
         simil::SpikeData* spikeData =
-            new simil::SpikeData( fileName, simil::TBlueConfig, target );
-
-        spikeData->reduceDataToGIDS( );
+            visimpl::SpikeCache::load( fileName, simil::TBlueConfig, target );
 
         _data = spikeData;
 
@@ -217,8 +215,11 @@ namespace stackviz
   {
     _simulationType = simulationType;
 
+    _data = visimpl::SpikeCache::load( networkFile, simil::THDF5,
+                                       activityFile );
+
     simil::SpikesPlayer* player = new simil::SpikesPlayer( );
-    player->LoadData( simil::TDataType::THDF5,  networkFile, activityFile );
+    player->LoadData( _data );
     _player = player;
 
     _subsetEventManager = _player->data( )->subsetsEvents( );
@@ -245,10 +246,13 @@ namespace stackviz
   {
     _simulationType = simulationType;
 
+    _data = visimpl::SpikeCache::load( networkFile, simil::TCSV,
+                                       activityFile );
+
     simil::SpikesPlayer* player = new simil::SpikesPlayer( );
     _player = player;
 
-    player->LoadData( simil::TDataType::TCSV, networkFile, activityFile );
+    player->LoadData( _data );
 
     _subsetEventManager = _player->data( )->subsetsEvents( );
 
@@ -274,14 +278,29 @@ namespace stackviz
       return;
 
     if( !append )
+    {
       _subsetEventManager->clear( );
+      _summary->subsetIndex( nullptr );
+    }
 
     _summary->clearEvents( );
 
     if( filePath.find( "json" ) != std::string::npos )
     {
       std::cout << "Loading JSON file: " << filePath << std::endl;
-      _subsetEventManager->loadJSON( filePath );
+
+      // A single index backs the session, appended files go through SimIL.
+      std::shared_ptr< visimpl::SubsetIndex > index;
+      if( !_summary->subsetIndex( ))
+        index = visimpl::SubsetIndex::load( filePath );
+
+      if( index )
+      {
+        index->exportEvents( _subsetEventManager );
+        _summary->subsetIndex( index );
+      }
+      else
+        _subsetEventManager->loadJSON( filePath );
     }
     else if( filePath.find( "h5" ) != std::string::npos )
     {
@@ -1010,7 +1029,9 @@ namespace stackviz
 
   void MainWindow::calculateCorrelations( void )
   {
-    visimpl::CorrelationComputer cc ( dynamic_cast< simil::SpikeData* >( _player->data( )));
+    visimpl::CorrelationComputer cc ( dynamic_cast< simil::SpikeData* >( _player->data( )),
+                                      _summary->gidDictionary( ));
+    cc.subsetIndex( _summary->subsetIndex( ));
 
     auto eventNames = _subsetEventManager->eventNames( );
 
@@ -44,6 +44,7 @@ int main( int argc, char** argv )
   std::string report ( "" );
   std::string subsetEventFile( "" );
   std::string correlations( "" );
+  std::string traceFile( "" );
 
   simil::TDataType dataType = simil::TBlueConfig;
   simil::TSimulationType simType = simil::TSimSpikes;
@@ -133,6 +134,16 @@ int main( int argc, char** argv )
         usageMessage( argv[0] );
     }
 
+    if( std::strcmp( argv[ i ], "-trace" ) == 0 )
+    {
+      if(++i < argc )
+      {
+        traceFile = argv[ i ];
+      }
+      else
+        usageMessage( argv[0] );
+    }
+
 //    if( std::strcmp( argv[ i ], "-spikes" ) == 0 )
 //    {
 //       simType = simil::TSimSpikes;
@@ -170,6 +181,9 @@ int main( int argc, char** argv )
     }
   }
 
+  if( !traceFile.empty( ))
+    visimpl::PhaseTracer::instance( ).enable( traceFile );
+
   stackviz::MainWindow mainWindow;
   mainWindow.setWindowTitle("StackViz");
 
@@ -211,7 +225,12 @@ int main( int argc, char** argv )
     default:
       break;
   }
-  return application.exec();
+  int result = application.exec( );
+
+  if( !traceFile.empty( ))
+    visimpl::PhaseTracer::instance( ).write( );
+
+  return result;
 
 }
 
@@ -225,6 +244,8 @@ void usageMessage( char* progName )
             << std::endl
             << "\t[ -se <subset_events_file> ] "
             << std::endl
+            << "\t[ -trace <chrome_trace_file.json> ]"
+            << std::endl
             << "\t[ -zeq <session_name*> ]"
             << std::endl
             << "\t[ -ws | --window-size ] <width> <height> ]"
@@ -0,0 +1,469 @@
+/*
+ * @file  CSVLoader.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include "CSVLoader.h"
+#include "GIDDictionary.h"
+#include "PhaseTracer.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#ifdef VISIMPL_USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace visimpl
+{
+  static inline bool isSeparator( char c )
+  {
+    return c == ',' || c == ';' || c == ' ' || c == '\t' || c == '\r';
+  }
+
+  static inline const char* skipSeparators( const char* it, const char* end )
+  {
+    while( it < end && isSeparator( *it ))
+      ++it;
+    return it;
+  }
+
+  static inline const char* nextLine( const char* it, const char* end )
+  {
+    while( it < end && *it != '\n' )
+      ++it;
+    return it < end ? it + 1 : end;
+  }
+
+  static inline bool parseUInt( const char*& it, const char* end,
+                                uint32_t& value )
+  {
+    it = skipSeparators( it, end );
+
+    if( it >= end || *it < '0' || *it > '9' )
+      return false;
+
+    uint32_t result = 0;
+    while( it < end && *it >= '0' && *it <= '9' )
+    {
+      result = result * 10 + ( *it - '0' );
+      ++it;
+    }
+
+    value = result;
+    return true;
+  }
+
+  static inline bool parseFloat( const char*& it, const char* end,
+                                 float& value )
+  {
+    it = skipSeparators( it, end );
+
+    if( it >= end )
+      return false;
+
+    bool negative = false;
+    if( *it == '-' || *it == '+' )
+    {
+      negative = *it == '-';
+      ++it;
+    }
+
+    double result = 0.0;
+    bool digits = false;
+    while( it < end && *it >= '0' && *it <= '9' )
+    {
+      result = result * 10.0 + ( *it - '0' );
+      digits = true;
+      ++it;
+    }
+
+    if( it < end && *it == '.' )
+    {
+      ++it;
+      double factor = 0.1;
+      while( it < end && *it >= '0' && *it <= '9' )
+      {
+        result += ( *it - '0' ) * factor;
+        factor *= 0.1;
+        digits = true;
+        ++it;
+      }
+    }
+
+    if( !digits )
+      return false;
+
+    if( it < end && ( *it == 'e' || *it == 'E' ))
+    {
+      ++it;
+      bool negativeExp = false;
+      if( it < end && ( *it == '-' || *it == '+' ))
+      {
+        negativeExp = *it == '-';
+        ++it;
+      }
+
+      int exponent = 0;
+      while( it < end && *it >= '0' && *it <= '9' )
+      {
+        exponent = exponent * 10 + ( *it - '0' );
+        ++it;
+      }
+
+      result *= std::pow( 10.0, negativeExp ? -exponent : exponent );
+    }
+
+    value = static_cast< float >( negative ? -result : result );
+    return true;
+  }
+
+  // Threads the parsing and sorting loops run on.
+  static unsigned int parseThreads( void )
+  {
+#ifdef VISIMPL_USE_OPENMP
+    return std::max( 1, omp_get_max_threads( ));
+#else
+    return 1;
+#endif
+  }
+
+  CSVLoader::CSVLoader( void )
+  : _threads( parseThreads( ))
+  , _startTime( 0.0f )
+  , _endTime( 0.0f )
+  { }
+
+  std::vector< CSVLoader::TChunk >
+  CSVLoader::_splitChunks( const char* begin, const char* end ) const
+  {
+    std::vector< TChunk > chunks;
+
+    size_t size = end - begin;
+    size_t chunksNumber = std::max( size_t( 1 ),
+        std::min( size_t( _threads * 4 ), size / ( 1 << 16 )));
+    size_t chunkSize = size / chunksNumber;
+
+    const char* chunkBegin = begin;
+    for( size_t i = 0; i < chunksNumber && chunkBegin < end; ++i )
+    {
+      const char* chunkEnd = ( i == chunksNumber - 1 ) ?
+          end : nextLine( std::max( chunkBegin, begin + ( i + 1 ) * chunkSize ),
+                          end );
+
+      chunks.emplace_back( chunkBegin, chunkEnd );
+      chunkBegin = chunkEnd;
+    }
+
+    return chunks;
+  }
+
+  bool CSVLoader::loadNetwork( const std::string& fileName )
+  {
+    ScopedPhase phase( "Parse network" );
+
+    QFile file( QString::fromStdString( fileName ));
+    if( !file.open( QIODevice::ReadOnly ))
+    {
+      std::cerr << "Could not open network file " << fileName << std::endl;
+      return false;
+    }
+
+    auto startClock = std::chrono::steady_clock::now( );
+
+    const qint64 fileSize = file.size( );
+    const char* data = reinterpret_cast< const char* >(
+        file.map( 0, fileSize ));
+    if( !data )
+    {
+      std::cerr << "Could not map network file " << fileName << std::endl;
+      return false;
+    }
+
+    auto chunks = _splitChunks( data, data + fileSize );
+
+    typedef std::pair< uint32_t, vmml::Vector3f > TNeuron;
+    std::vector< std::vector< TNeuron >> parsed( chunks.size( ));
+
+  #ifdef VISIMPL_USE_OPENMP
+    #pragma omp parallel for schedule( dynamic, 1 )
+  #endif
+    for( int i = 0; i < ( int ) chunks.size( ); ++i )
+    {
+      const char* it = chunks[ i ].first;
+      const char* end = chunks[ i ].second;
+
+      auto& neurons = parsed[ i ];
+      neurons.reserve(( end - it ) / 24 );
+
+      while( it < end )
+      {
+        const char* line = it;
+        uint32_t gid;
+        float x, y, z;
+
+        if( parseUInt( line, end, gid ) && parseFloat( line, end, x ) &&
+            parseFloat( line, end, y ) && parseFloat( line, end, z ))
+          neurons.emplace_back( gid, vmml::Vector3f( x, y, z ));
+
+        it = nextLine( line, end );
+      }
+    }
+
+    std::vector< TNeuron > neurons;
+    for( auto& chunk : parsed )
+      neurons.insert( neurons.end( ), chunk.begin( ), chunk.end( ));
+
+    // Positions follow the gid set order.
+    std::sort( neurons.begin( ), neurons.end( ),
+               []( const TNeuron& a, const TNeuron& b )
+               { return a.first < b.first; });
+
+    _gids.clear( );
+    _positions.clear( );
+    _positions.reserve( neurons.size( ));
+    for( auto& neuron : neurons )
+    {
+      if( _gids.insert( neuron.first ).second )
+        _positions.push_back( neuron.second );
+    }
+
+    file.unmap( reinterpret_cast< uchar* >( const_cast< char* >( data )));
+
+    std::chrono::duration< double > elapsed =
+        std::chrono::steady_clock::now( ) - startClock;
+    _reportThroughput( "network", fileSize, _gids.size( ), elapsed.count( ));
+
+    return true;
+  }
+
+  bool CSVLoader::loadActivity( const std::string& fileName )
+  {
+    ScopedPhase phase( "Parse activity" );
+
+    QFile file( QString::fromStdString( fileName ));
+    if( !file.open( QIODevice::ReadOnly ))
+    {
+      std::cerr << "Could not open activity file " << fileName << std::endl;
+      return false;
+    }
+
+    auto startClock = std::chrono::steady_clock::now( );
+
+    const qint64 fileSize = file.size( );
+    const char* data = reinterpret_cast< const char* >(
+        file.map( 0, fileSize ));
+    if( !data )
+    {
+      std::cerr << "Could not map activity file " << fileName << std::endl;
+      return false;
+    }
+
+    auto chunks = _splitChunks( data, data + fileSize );
+
+    std::vector< TSpikes > parsed( chunks.size( ));
+
+  #ifdef VISIMPL_USE_OPENMP
+    #pragma omp parallel for schedule( dynamic, 1 )
+  #endif
+    for( int i = 0; i < ( int ) chunks.size( ); ++i )
+    {
+      const char* it = chunks[ i ].first;
+      const char* end = chunks[ i ].second;
+
+      auto& spikes = parsed[ i ];
+      spikes.reserve(( end - it ) / 12 );
+
+      while( it < end )
+      {
+        const char* line = it;
+        uint32_t gid;
+        float time;
+
+        if( parseUInt( line, end, gid ) && parseFloat( line, end, time ))
+          spikes.emplace_back( time, gid );
+
+        it = nextLine( line, end );
+      }
+    }
+
+    file.unmap( reinterpret_cast< uchar* >( const_cast< char* >( data )));
+
+    std::vector< size_t > chunkOffsets( parsed.size( ) + 1, 0 );
+    for( unsigned int i = 0; i < parsed.size( ); ++i )
+      chunkOffsets[ i + 1 ] = chunkOffsets[ i ] + parsed[ i ].size( );
+
+    _spikes.clear( );
+    _spikes.resize( chunkOffsets.back( ));
+
+  #ifdef VISIMPL_USE_OPENMP
+    #pragma omp parallel for
+  #endif
+    for( int i = 0; i < ( int ) parsed.size( ); ++i )
+    {
+      std::copy( parsed[ i ].begin( ), parsed[ i ].end( ),
+                 _spikes.begin( ) + chunkOffsets[ i ]);
+      TSpikes( ).swap( parsed[ i ]);
+    }
+
+    _sortSpikes( chunkOffsets );
+
+    _startTime = _spikes.empty( ) ? 0.0f : std::min( 0.0f, _spikes.front( ).first );
+    _endTime = _spikes.empty( ) ? 0.0f : _spikes.back( ).first;
+
+    std::chrono::duration< double > elapsed =
+        std::chrono::steady_clock::now( ) - startClock;
+    _reportThroughput( "activity", fileSize, _spikes.size( ), elapsed.count( ));
+
+    return true;
+  }
+
+  void CSVLoader::_sortSpikes( std::vector< size_t >& chunkOffsets )
+  {
+    auto timeCompare = []( const Spike& a, const Spike& b )
+        { return a.first < b.first; };
+
+    const int chunksNumber = ( int ) chunkOffsets.size( ) - 1;
+
+    // Sort every chunk on its own, then merge neighbours pairwise. Exports
+    // are usually already time-ordered, so most chunks are just checked.
+  #ifdef VISIMPL_USE_OPENMP
+    #pragma omp parallel for schedule( dynamic, 1 )
+  #endif
+    for( int i = 0; i < chunksNumber; ++i )
+    {
+      auto begin = _spikes.begin( ) + chunkOffsets[ i ];
+      auto end = _spikes.begin( ) + chunkOffsets[ i + 1 ];
+      if( !std::is_sorted( begin, end, timeCompare ))
+        std::stable_sort( begin, end, timeCompare );
+    }
+
+    for( int width = 1; width < chunksNumber; width *= 2 )
+    {
+  #ifdef VISIMPL_USE_OPENMP
+      #pragma omp parallel for schedule( dynamic, 1 )
+  #endif
+      for( int i = 0; i < chunksNumber - width; i += 2 * width )
+      {
+        auto begin = _spikes.begin( ) + chunkOffsets[ i ];
+        auto middle = _spikes.begin( ) + chunkOffsets[ i + width ];
+        auto end = _spikes.begin( ) +
+            chunkOffsets[ std::min( i + 2 * width, chunksNumber )];
+
+        if( middle != begin && middle != end &&
+            timeCompare( *middle, *( middle - 1 )))
+          std::inplace_merge( begin, middle, end, timeCompare );
+      }
+    }
+  }
+
+  void CSVLoader::_reportThroughput( const std::string& label, size_t bytes,
+                                     size_t elements, double seconds ) const
+  {
+    double megabytes = double( bytes ) / ( 1024.0 * 1024.0 );
+    seconds = std::max( seconds, 1e-9 );
+
+    std::cout << "CSV " << label << ": " << elements << " entries, "
+              << megabytes << " MB in " << seconds << " s ("
+              << megabytes / seconds << " MB/s, "
+              << elements / seconds << " " << label << " entries/s) using "
+              << _threads << " threads"
+              << std::endl;
+  }
+
+  const TGIDSet& CSVLoader::gids( void ) const
+  {
+    return _gids;
+  }
+
+  const TPosVect& CSVLoader::positions( void ) const
+  {
+    return _positions;
+  }
+
+  const TSpikes& CSVLoader::spikes( void ) const
+  {
+    return _spikes;
+  }
+
+  TSpikes CSVLoader::takeSpikes( void )
+  {
+    TSpikes spikes;
+    spikes.swap( _spikes );
+
+    return spikes;
+  }
+
+  float CSVLoader::startTime( void ) const
+  {
+    return _startTime;
+  }
+
+  float CSVLoader::endTime( void ) const
+  {
+    return _endTime;
+  }
+
+  void CSVLoader::reduceDataToGIDS( void )
+  {
+    ScopedPhase phase( "reduceDataToGIDS" );
+
+    GIDDictionary dictionary( _gids );
+
+    _spikes.erase( std::remove_if( _spikes.begin( ), _spikes.end( ),
+                                   [ &dictionary ]( const Spike& spike )
+                                   { return !dictionary.contains( spike.second ); }),
+                   _spikes.end( ));
+  }
+
+  simil::SpikeData* CSVLoader::spikeData( void ) const
+  {
+    simil::SpikeData* result = new simil::SpikeData( );
+    result->setGids( _gids );
+    result->setPositions( _positions );
+    result->setSpikes( _spikes );
+    result->setStartTime( _startTime );
+    result->setEndTime( _endTime );
+
+    return result;
+  }
+
+  simil::SpikeData* CSVLoader::load( const std::string& networkFile,
+                                     const std::string& activityFile )
+  {
+    CSVLoader loader;
+
+    if( !loader.loadNetwork( networkFile ) ||
+        !loader.loadActivity( activityFile ))
+    {
+      std::cerr << "Falling back to SimIL CSV loader." << std::endl;
+      simil::SpikeData* result = nullptr;
+      {
+        ScopedPhase phase( "Parse" );
+        result = new simil::SpikeData( networkFile, simil::TCSV, activityFile );
+      }
+      {
+        ScopedPhase phase( "reduceDataToGIDS" );
+        result->reduceDataToGIDS( );
+      }
+      return result;
+    }
+
+    simil::SpikeData* result = loader.spikeData( );
+    {
+      ScopedPhase phase( "reduceDataToGIDS" );
+      result->reduceDataToGIDS( );
+    }
+
+    return result;
+  }
+
+}
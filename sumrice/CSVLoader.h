@@ -0,0 +1,79 @@
+/*
+ * @file  CSVLoader.h
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+#ifndef __VISIMPL_CSVLOADER__
+#define __VISIMPL_CSVLOADER__
+
+#include <string>
+#include <vector>
+
+#include <simil/simil.h>
+
+#include "types.h"
+
+namespace visimpl
+{
+
+  /*
+   * Multi-threaded reader for CSV network ("gid,x,y,z") and activity
+   * ("gid,time") files. Files are mapped, split in chunks at line boundaries
+   * and parsed on every available core. Lines that do not start with a
+   * number (headers, comments) are skipped.
+   */
+  class CSVLoader
+  {
+  public:
+
+    CSVLoader( void );
+
+    bool loadNetwork( const std::string& fileName );
+    bool loadActivity( const std::string& fileName );
+
+    const TGIDSet& gids( void ) const;
+    const TPosVect& positions( void ) const;
+    const TSpikes& spikes( void ) const;
+
+    // Moves the parsed spikes out of the loader.
+    TSpikes takeSpikes( void );
+
+    float startTime( void ) const;
+    float endTime( void ) const;
+
+    // Drops spikes of gids missing from the network, as SpikeData does.
+    void reduceDataToGIDS( void );
+
+    simil::SpikeData* spikeData( void ) const;
+
+    static simil::SpikeData* load( const std::string& networkFile,
+                                   const std::string& activityFile );
+
+  protected:
+
+    typedef std::pair< const char*, const char* > TChunk;
+
+    std::vector< TChunk > _splitChunks( const char* begin,
+                                        const char* end ) const;
+
+    void _sortSpikes( std::vector< size_t >& chunkOffsets );
+
+    void _reportThroughput( const std::string& label, size_t bytes,
+                            size_t elements, double seconds ) const;
+
+    unsigned int _threads;
+
+    TGIDSet _gids;
+    TPosVect _positions;
+    TSpikes _spikes;
+
+    float _startTime;
+    float _endTime;
+  };
+
+}
+
+#endif /* __VISIMPL_CSVLOADER__ */
@@ -9,13 +9,48 @@
 
 #include "CorrelationComputer.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace visimpl
 {
 
-  CorrelationComputer::CorrelationComputer( simil::SpikeData* simData )
+  CorrelationComputer::CorrelationComputer( simil::SpikeData* simData,
+                                            TGIDDictionaryPtr gidDictionary )
   : _simData( simData )
+  , _gidDictionary( gidDictionary )
   , _subsetEvents( simData->subsetsEvents( ))
-  { }
+  , _spikeStore( nullptr )
+  {
+    if( !_gidDictionary )
+      _gidDictionary =
+          std::make_shared< const GIDDictionary >( _simData->gids( ));
+  }
+
+  void CorrelationComputer::subsetIndex( TSubsetIndexPtr index )
+  {
+    _subsetIndex = index;
+  }
+
+  void CorrelationComputer::spikeStore( SpikePageStore* store )
+  {
+    _spikeStore = store;
+  }
+
+  GIDVec CorrelationComputer::_subset( const std::string& name ) const
+  {
+    if( _subsetIndex )
+    {
+      uint64_t position = _subsetIndex->findSubset( name );
+      if( position < _subsetIndex->subsetsNumber( ))
+      {
+        auto range = _subsetIndex->subsetGids( position );
+        return GIDVec( range.first, range.second );
+      }
+    }
+
+    return _subsetEvents->getSubset( name );
+  }
 
   void CorrelationComputer::configureEvents( const std::vector< std::string >& eventsNames,
                                              double deltaTime )
@@ -64,7 +99,7 @@ namespace visimpl
                                             float /*selectionThreshold*/ )
   {
 
-    GIDVec gids = _subsetEvents->getSubset( subset );
+    GIDVec gids = _subset( subset );
     Correlation correlation_;
 
     if( gids.empty( ))
@@ -80,13 +115,27 @@ namespace visimpl
       return correlation_;
     }
 
-    TGIDUSet giduset( gids.begin( ), gids.end( ));
+    // Position of every network neuron inside the subset, indexed through
+    // the dense gid dictionary.
+    std::vector< uint32_t > subsetIndex( _gidDictionary->size( ),
+                                         GIDDictionary::INVALID );
+    GIDVec subsetGids;
+    subsetGids.reserve( gids.size( ));
+    for( auto gid : gids )
+    {
+      uint32_t idx = _gidDictionary->index( gid );
+      if( idx == GIDDictionary::INVALID ||
+          subsetIndex[ idx ] != GIDDictionary::INVALID )
+        continue;
 
-    const TSpikes& spikes = _simData->spikes( );
+      subsetIndex[ idx ] = subsetGids.size( );
+      subsetGids.push_back( gid );
+    }
 
     enum tSRecord { tPatternFiring = 0, tNotPatternFiring, tPatternNotFiring, tNotPatternNotFiring, tTotalFiring };
     typedef std::tuple< unsigned int, unsigned int, unsigned int, unsigned int, unsigned int >  tSpikesRecord;
-    std::unordered_map< uint32_t, tSpikesRecord > neuronSpikes;
+    std::vector< tSpikesRecord > neuronSpikes( subsetGids.size( ),
+                                               std::make_tuple( 0, 0, 0, 0, 0 ));
 //    std::map< uint32_t, unsigned int > totalNeuronSpikes;
 
     // Calculate delta time inverse to avoid further division operations.
@@ -137,28 +186,37 @@ namespace visimpl
 
     std::cout << "Pattern " << eventName << " entropy " << entropyPattern << std::endl;
 
-    std::vector< std::set< uint32_t >> binSpikes( totalBins );
-    std::unordered_map< uint32_t, std::unordered_set< unsigned int >> neuronActiveBins;
+    // Spikes are time-sorted, so every neuron's fired bins come out sorted.
+    std::vector< std::vector< unsigned int >> neuronActiveBins(
+        subsetGids.size( ));
 
-    for( auto gid : gids )
+    auto binSpikes = [ & ]( const simil::SpikesCRange& range )
     {
-      neuronSpikes.insert( std::make_pair( gid, std::make_tuple( 0, 0, 0, 0, 0 )));
-      neuronActiveBins.insert(
-          std::make_pair( gid, std::unordered_set< unsigned int >( )));
-    }
+      for( auto spike = range.first; spike != range.second; ++spike )
+      {
+        uint32_t idx = _gidDictionary->index( spike->second );
+        if( idx == GIDDictionary::INVALID )
+          continue;
 
-    for( const auto& spike : spikes )
-    {
-      if( giduset.find( spike.second ) == giduset.end( ))
-        continue;
+        uint32_t neuron = subsetIndex[ idx ];
+        if( neuron == GIDDictionary::INVALID )
+          continue;
 
-      unsigned int binIdx = std::floor( spike.first * invDeltaTime );
+        unsigned int binIdx = std::floor( spike->first * invDeltaTime );
 
-      binSpikes[ binIdx ].insert( spike.second );
+        auto& firedBins = neuronActiveBins[ neuron ];
+        if( firedBins.empty( ) || firedBins.back( ) != binIdx )
+          firedBins.push_back( binIdx );
+      }
+    };
 
-      auto neuronBinFired = neuronActiveBins.find( spike.second );
-      neuronBinFired->second.insert( binIdx );
-    }
+    if( _spikeStore )
+      _spikeStore->visitSpikes( -std::numeric_limits< float >::max( ),
+                                std::numeric_limits< float >::max( ),
+                                binSpikes );
+    else
+      binSpikes( std::make_pair( _simData->spikes( ).cbegin( ),
+                                 _simData->spikes( ).cend( )));
 
     unsigned int startBin = std::floor( initTime / deltaTime );
     unsigned int endBin = std::ceil( endTime / deltaTime );
@@ -166,14 +224,13 @@ namespace visimpl
     std::cout << "Bin range [" << startBin << ", " << endBin << "] "
               << initTime << " " << endTime << std::endl;
 
-    for( auto gid : gids )
+    for( unsigned int neuron = 0; neuron < subsetGids.size( ); ++neuron )
     {
-      auto neuron = neuronSpikes.find( gid );
-
-//      auto gid = neuron->first;
-      auto& stats = neuron->second;
+      auto& stats = neuronSpikes[ neuron ];
 
-      auto firedBins = neuronActiveBins.find( gid );
+      const auto& firedBins = neuronActiveBins[ neuron ];
+      auto firedBin = std::lower_bound( firedBins.begin( ), firedBins.end( ),
+                                        startBin );
 
       unsigned int totalFiringBins = 0;
       unsigned int firedPattern = 0;
@@ -183,7 +240,10 @@ namespace visimpl
 
       for( unsigned int i = startBin; i < endBin; ++i )
       {
-        bool fired = firedBins->second.find( i ) != firedBins->second.end( );
+        bool fired = firedBin != firedBins.end( ) && *firedBin == i;
+        if( fired )
+          ++firedBin;
+
         bool pattern = eventBins[ i ];
 
         if( fired )
@@ -233,7 +293,7 @@ namespace visimpl
 
     correlation_.subsetName = subset;
     correlation_.eventName = eventName;
-    correlation_.gids = giduset;
+    correlation_.gids.insert( gids.begin( ), gids.end( ));
 
     // Calculate normalization factors by the inverse of active/inactive bins.
     double normBins = 1.0 / analysisTotalBins;
@@ -257,18 +317,17 @@ namespace visimpl
     unsigned int binsTotalFiring = 0;
 
     // For each neuron...
-    for( auto gid : gids )
+    for( unsigned int neuron = 0; neuron < subsetGids.size( ); ++neuron )
     {
+      auto gid = subsetGids[ neuron ];
+      const auto& neuronStats = neuronSpikes[ neuron ];
 
-      auto neuronStats = neuronSpikes.find( gid );
-//      auto neuronTotalSpikes = totalNeuronSpikes.find( gid );
-
-      binsFiringPattern = std::get< tPatternFiring >( neuronStats->second );
-      binsFiringNotPattern = std::get< tNotPatternFiring >( neuronStats->second );
-      binsNotFiringPattern = std::get< tPatternNotFiring >( neuronStats->second );
-      binsNotFiringNotPattern = std::get< tNotPatternNotFiring >( neuronStats->second );
+      binsFiringPattern = std::get< tPatternFiring >( neuronStats );
+      binsFiringNotPattern = std::get< tNotPatternFiring >( neuronStats );
+      binsNotFiringPattern = std::get< tPatternNotFiring >( neuronStats );
+      binsNotFiringNotPattern = std::get< tNotPatternNotFiring >( neuronStats );
 
-      binsTotalFiring = std::get< tTotalFiring >( neuronStats->second );
+      binsTotalFiring = std::get< tTotalFiring >( neuronStats );
 
 //      unsigned int binsFiringTotal = std::get< tTotalFiring >( neuronStats->second );
 //      unsigned int binsRest =
@@ -374,8 +433,7 @@ namespace visimpl
                                   float endTime,
                                   float selectionThreshold )
   {
-    std::vector< uint32_t > gids =
-        _subsetEvents->getSubset( subsetName );
+    std::vector< uint32_t > gids = _subset( subsetName );
 
     std::vector< Correlation > result;
 
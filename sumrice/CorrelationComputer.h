@@ -10,6 +10,9 @@
 #define __SIMIL_CORRELATIONCOMPUTER__
 
 #include "types.h"
+#include "GIDDictionary.h"
+#include "SubsetIndex.h"
+#include "SpikePageStore.h"
 
 #include <unordered_map>
 #include <simil/simil.h>
@@ -22,7 +25,8 @@ namespace visimpl
   public:
 
     SIMIL_API
-    CorrelationComputer( simil::SpikeData* simData );
+    CorrelationComputer( simil::SpikeData* simData,
+                         TGIDDictionaryPtr gidDictionary = nullptr );
 
     void configureEvents( const std::vector< std::string >& events,
                           double deltaTime );
@@ -49,8 +53,15 @@ namespace visimpl
 
     GIDUSet getCorrelatedNeurons( const std::string& correlationName ) const;
 
+    void subsetIndex( TSubsetIndexPtr index );
+
+    // Paged spikes are read from the store instead of simData.
+    void spikeStore( SpikePageStore* store );
+
   protected:
 
+    GIDVec _subset( const std::string& name ) const;
+
     std::vector< float > _eventTimePerBin( const std::string& event,
                                     float startTime,
                                     float endTime,
@@ -61,8 +72,11 @@ namespace visimpl
     std::string _composeName( const std::string& subsetName, const std::string& eventName ) const;
 
     simil::SpikeData* _simData;
+    TGIDDictionaryPtr _gidDictionary;
 
     simil::SubsetEventManager* _subsetEvents;
+    TSubsetIndexPtr _subsetIndex;
+    SpikePageStore* _spikeStore;
 
     double _startTime;
     double _endTime;
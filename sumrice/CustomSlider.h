@@ -10,8 +10,13 @@
 #ifndef __QT_CUSTOMSLIDER_H__
 #define __QT_CUSTOMSLIDER_H__
 
+#include <algorithm>
+#include <cstdlib>
+
 #include <QMouseEvent>
+#include <QPainter>
 #include <QSlider>
+#include <QStyle>
 
 class CustomSlider : public QSlider
 {
@@ -20,8 +25,19 @@ public:
   CustomSlider( enum Qt::Orientation _orientation = Qt::Horizontal,
                 QWidget* _parent = nullptr )
   : QSlider( _orientation, _parent )
+  , _markerA( -1 )
+  , _markerB( -1 )
   { }
 
+  // A-B loop markers drawn over a horizontal groove, in slider values.
+  // Negative values hide them.
+  void markers( int markerA, int markerB )
+  {
+    _markerA = markerA;
+    _markerB = markerB;
+    update( );
+  }
+
 protected:
 
   void mousePressEvent ( QMouseEvent * _event )
@@ -38,6 +54,36 @@ protected:
       QSlider::mousePressEvent(_event);
     }
 
+  void paintEvent( QPaintEvent* _event )
+    {
+      QSlider::paintEvent( _event );
+
+      if( orientation( ) != Qt::Horizontal || _markerA < 0 )
+        return;
+
+      QPainter painter( this );
+      QColor color( 255, 140, 0 );
+
+      int xA = QStyle::sliderPositionFromValue( minimum( ), maximum( ),
+                                                _markerA, width( ));
+      painter.setPen( color );
+      painter.drawLine( xA, 0, xA, height( ));
+
+      if( _markerB < 0 )
+        return;
+
+      int xB = QStyle::sliderPositionFromValue( minimum( ), maximum( ),
+                                                _markerB, width( ));
+      painter.drawLine( xB, 0, xB, height( ));
+
+      color.setAlpha( 60 );
+      painter.fillRect( std::min( xA, xB ), 0, std::abs( xB - xA ), height( ),
+                        color );
+    }
+
+  int _markerA;
+  int _markerB;
+
 };
 
 
@@ -0,0 +1,87 @@
+/*
+ * @file  GIDDictionary.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include "GIDDictionary.h"
+
+namespace visimpl
+{
+  // Maximum table entries per gid before switching to the hashed lookup.
+  static const size_t DENSE_TABLE_RATIO = 8;
+
+  GIDDictionary::GIDDictionary( void )
+  : _dense( true )
+  , _minGid( 0 )
+  { }
+
+  GIDDictionary::GIDDictionary( const TGIDSet& gids_ )
+  : _gids( gids_.begin( ), gids_.end( ))
+  , _dense( true )
+  , _minGid( 0 )
+  {
+    if( _gids.empty( ))
+      return;
+
+    _minGid = _gids.front( );
+    size_t range = size_t( _gids.back( ) - _minGid ) + 1;
+
+    _dense = range <= _gids.size( ) * DENSE_TABLE_RATIO;
+
+    if( _dense )
+    {
+      _table.resize( range, INVALID );
+      for( uint32_t i = 0; i < _gids.size( ); ++i )
+        _table[ _gids[ i ] - _minGid ] = i;
+    }
+    else
+    {
+      _sparse.reserve( _gids.size( ));
+      for( uint32_t i = 0; i < _gids.size( ); ++i )
+        _sparse.insert( std::make_pair( _gids[ i ], i ));
+    }
+  }
+
+  size_t GIDDictionary::size( void ) const
+  {
+    return _gids.size( );
+  }
+
+  const std::vector< uint32_t >& GIDDictionary::gids( void ) const
+  {
+    return _gids;
+  }
+
+  TGIDMask GIDDictionary::mask( const GIDUSet& subset ) const
+  {
+    TGIDMask result( _gids.size( ), false );
+
+    for( auto gid_ : subset )
+    {
+      uint32_t idx = index( gid_ );
+      if( idx != INVALID )
+        result[ idx ] = true;
+    }
+
+    return result;
+  }
+
+  TGIDMask GIDDictionary::mask( const GIDVec& subset ) const
+  {
+    TGIDMask result( _gids.size( ), false );
+
+    for( auto gid_ : subset )
+    {
+      uint32_t idx = index( gid_ );
+      if( idx != INVALID )
+        result[ idx ] = true;
+    }
+
+    return result;
+  }
+
+}
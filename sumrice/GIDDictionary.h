@@ -0,0 +1,87 @@
+/*
+ * @file  GIDDictionary.h
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+#ifndef __VISIMPL_GIDDICTIONARY__
+#define __VISIMPL_GIDDICTIONARY__
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "types.h"
+
+namespace visimpl
+{
+  typedef std::vector< bool > TGIDMask;
+
+  /*
+   * Immutable mapping between the network gids and dense indices
+   * [ 0, size ), following the ascending gid order. Lookups index a flat
+   * table when the gid range is compact and fall back to hashing otherwise,
+   * so per-spike membership tests become an index plus a mask bit test.
+   */
+  class GIDDictionary
+  {
+  public:
+
+    static const uint32_t INVALID = 0xFFFFFFFF;
+
+    GIDDictionary( void );
+    GIDDictionary( const TGIDSet& gids );
+
+    size_t size( void ) const;
+
+    inline uint32_t index( uint32_t gid ) const
+    {
+      if( _dense )
+      {
+        uint32_t offset = gid - _minGid;
+        return ( gid < _minGid || offset >= _table.size( )) ?
+            INVALID : _table[ offset ];
+      }
+
+      auto it = _sparse.find( gid );
+      return it == _sparse.end( ) ? INVALID : it->second;
+    }
+
+    inline uint32_t gid( uint32_t index_ ) const
+    {
+      return _gids[ index_ ];
+    }
+
+    inline bool contains( uint32_t gid_ ) const
+    {
+      return index( gid_ ) != INVALID;
+    }
+
+    inline bool test( const TGIDMask& mask, uint32_t gid_ ) const
+    {
+      uint32_t idx = index( gid_ );
+      return idx != INVALID && mask[ idx ];
+    }
+
+    const std::vector< uint32_t >& gids( void ) const;
+
+    TGIDMask mask( const GIDUSet& subset ) const;
+    TGIDMask mask( const GIDVec& subset ) const;
+
+  protected:
+
+    std::vector< uint32_t > _gids;
+
+    bool _dense;
+    uint32_t _minGid;
+    std::vector< uint32_t > _table;
+    std::unordered_map< uint32_t, uint32_t > _sparse;
+  };
+
+  typedef std::shared_ptr< const GIDDictionary > TGIDDictionaryPtr;
+
+}
+
+#endif /* __VISIMPL_GIDDICTIONARY__ */
@@ -11,6 +11,8 @@
 
 #include "log.h"
 
+#include <limits>
+
 #include <QPainter>
 #include <QBrush>
 
@@ -41,6 +43,7 @@ namespace visimpl
   , _normRule( T_NORM_MAX )
   , _repMode( T_REP_DENSE )
   , _fillPlots( true )
+  , _spikeStore( nullptr )
   , _lastMousePosition( nullptr )
   , _regionPercentage( nullptr )
   , _paintRegion( false )
@@ -78,6 +81,7 @@ namespace visimpl
   , _normRule( T_NORM_MAX )
   , _repMode( T_REP_DENSE )
   , _fillPlots( true )
+  , _spikeStore( nullptr )
   , _lastMousePosition( nullptr )
   , _regionPercentage( nullptr )
   , _paintRegion( false )
@@ -112,6 +116,7 @@ namespace visimpl
   , _normRule( T_NORM_MAX )
   , _repMode( T_REP_DENSE )
   , _fillPlots( true )
+  , _spikeStore( nullptr )
   , _lastMousePosition( nullptr )
   , _regionPercentage( nullptr )
   , _paintRegion( false )
@@ -182,64 +187,138 @@ namespace visimpl
 
     bool filter = _filteredGIDs.size( ) > 0;
 
-#ifndef VISIMPL_USE_OPENMP
+    if( _spikeStore )
+    {
+      // Paged spikes: bin sizes come from the mapped times, only filtered
+      // bins decode their pages, one at a time.
+      float deltaTime = ( totalTime ) / histogram->size( );
+      int binsNumber = histogram->size( );
+
+      for( int i = 0; i < binsNumber; ++i )
+      {
+        float binStart = _startTime + i * deltaTime;
+        float binEnd = i == binsNumber - 1 ?
+            std::numeric_limits< float >::max( ) : binStart + deltaTime;
+        if( i == 0 )
+          binStart = -std::numeric_limits< float >::max( );
+
+        unsigned int binSpikes = _spikeStore->lowerBound( binEnd ) -
+            _spikeStore->lowerBound( binStart );
+        globalHistogram[ i ] = binSpikes;
 
-    float deltaTime = ( totalTime ) / histogram->size( );
-    float currentTime = _startTime + deltaTime;
+        if( !filter )
+        {
+          ( *histogram )[ i ] = binSpikes;
+          continue;
+        }
 
-    auto globalBin = globalHistogram.begin( );
-    auto spike = _spikes->begin( );
-    for( unsigned int& bin: *histogram )
+        unsigned int filtered = 0;
+        _spikeStore->visitSpikes( binStart, binEnd,
+            [ & ]( const simil::SpikesCRange& range )
+            {
+              for( auto spike = range.first; spike != range.second; ++spike )
+                if( _filtered( spike->second ))
+                  ++filtered;
+            });
+
+        ( *histogram )[ i ] = filtered;
+      }
+    }
+    else if( _spikeIndex && _spikeIndex->indexedSpikes( ) == _spikes->size( ))
     {
-      while( spike != _spikes->end( ) && spike->first <= currentTime )
+      // Bin limits are direct seeks, unfiltered bins are just range sizes.
+      float deltaTime = ( totalTime ) / histogram->size( );
+      int binsNumber = histogram->size( );
+
+#ifdef VISIMPL_USE_OPENMP
+      #pragma omp parallel for
+#endif
+      for( int i = 0; i < binsNumber; ++i )
       {
-        if( !filter || _filteredGIDs.find( spike->second ) != _filteredGIDs.end( ))
+        float binStart = _startTime + i * deltaTime;
+        auto range = _spikeIndex->spikesBetween(
+            i == 0 ? -std::numeric_limits< float >::max( ) : binStart,
+            i == binsNumber - 1 ? std::numeric_limits< float >::max( ) :
+                                  binStart + deltaTime );
+
+        unsigned int binSpikes = range.second - range.first;
+        globalHistogram[ i ] = binSpikes;
+
+        if( !filter )
         {
-          bin++;
+          ( *histogram )[ i ] = binSpikes;
+          continue;
         }
-        spike++;
-        (*globalBin)++;
-      }
 
-      currentTime += deltaTime;
-      ++globalBin;
+        unsigned int filtered = 0;
+        for( auto spike = range.first; spike != range.second; ++spike )
+          if( _filtered( spike->second ))
+            ++filtered;
+
+        ( *histogram )[ i ] = filtered;
+      }
     }
+    else
+    {
+#ifndef VISIMPL_USE_OPENMP
 
-#else
+      float deltaTime = ( totalTime ) / histogram->size( );
+      float currentTime = _startTime + deltaTime;
 
-    float invTotalTime = 1.0f / totalTime;
-    unsigned int numThreads = 4;
+      auto globalBin = globalHistogram.begin( );
+      auto spike = _spikes->begin( );
+      for( unsigned int& bin: *histogram )
+      {
+        while( spike != _spikes->end( ) && spike->first <= currentTime )
+        {
+          if( !filter || _filtered( spike->second ))
+          {
+            bin++;
+          }
+          spike++;
+          (*globalBin)++;
+        }
 
-    omp_set_dynamic( 0 );
-    omp_set_num_threads( numThreads );
-    const auto& references = _spikes->refData( );
-    for( int i = 0; i < ( int ) references.size( ); i++)
-    {
-      simil::TSpikes::const_iterator spikeIt = references[ i ];
+        currentTime += deltaTime;
+        ++globalBin;
+      }
 
-      float endTime = ( i < ( ( int )references.size( ) - 1 )) ?
-                      references[ i + 1]->first :
-                      _endTime;
+#else
+
+      float invTotalTime = 1.0f / totalTime;
+      unsigned int numThreads = 4;
 
-      int bin;
-      while( spikeIt->first < endTime && spikeIt != _spikes->end( ))
+      omp_set_dynamic( 0 );
+      omp_set_num_threads( numThreads );
+      const auto& references = _spikes->refData( );
+      for( int i = 0; i < ( int ) references.size( ); i++)
       {
-        float perc =
-            std::max( 0.0f,
-                      std::min( 1.0f, ( spikeIt->first - _startTime )* invTotalTime ));
-        bin = perc * histogram->size( );
+        simil::TSpikes::const_iterator spikeIt = references[ i ];
+
+        float endTime = ( i < ( ( int )references.size( ) - 1 )) ?
+                        references[ i + 1]->first :
+                        _endTime;
 
-        if( !filter || _filteredGIDs.find( spikeIt->second ) != _filteredGIDs.end( ))
+        int bin;
+        while( spikeIt->first < endTime && spikeIt != _spikes->end( ))
         {
-          ( *histogram )[ bin ]++;
+          float perc =
+              std::max( 0.0f,
+                        std::min( 1.0f, ( spikeIt->first - _startTime )* invTotalTime ));
+          bin = perc * histogram->size( );
+
+          if( !filter || _filtered( spikeIt->second ))
+          {
+            ( *histogram )[ bin ]++;
+          }
+          ( globalHistogram )[ bin ]++;
+          ++spikeIt;
         }
-        ( globalHistogram )[ bin ]++;
-        ++spikeIt;
-      }
 
-    }
+      }
 
 #endif // VISIMPL_USE_OPENMP
+    }
 
     unsigned int cont = 0;
 //    unsigned int maxPos = 0;
@@ -481,6 +560,27 @@ namespace visimpl
   {
 //    if( gids.size( ) > 0 )
       _filteredGIDs = gids;
+
+    _filterMask.clear( );
+    if( _gidDictionary )
+      _filterMask = _gidDictionary->mask( _filteredGIDs );
+  }
+
+  void HistogramWidget::gidDictionary( TGIDDictionaryPtr dictionary )
+  {
+    _gidDictionary = dictionary;
+
+    filteredGIDs( _filteredGIDs );
+  }
+
+  void HistogramWidget::spikeIndex( TSpikeTimeIndexPtr index )
+  {
+    _spikeIndex = index;
+  }
+
+  void HistogramWidget::spikeStore( SpikePageStore* store )
+  {
+    _spikeStore = store;
   }
 
   const GIDUSet& HistogramWidget::filteredGIDs( void ) const
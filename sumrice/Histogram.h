@@ -17,6 +17,9 @@
 #include <QFrame>
 
 #include "types.h"
+#include "GIDDictionary.h"
+#include "SpikeTimeIndex.h"
+#include "SpikePageStore.h"
 
 namespace visimpl
 {
@@ -93,6 +96,13 @@ namespace visimpl
     void filteredGIDs( const GIDUSet& gids );
     const GIDUSet& filteredGIDs( void ) const;
 
+    void gidDictionary( TGIDDictionaryPtr dictionary );
+
+    void spikeIndex( TSpikeTimeIndexPtr index );
+
+    // Spikes of a paged dataset, read instead of the resident ones.
+    void spikeStore( SpikePageStore* store );
+
     void colorScaleLocal( TColorScale scale );
     TColorScale colorScaleLocal( void ) const;
 
@@ -164,6 +174,14 @@ signals:
 
   protected:
 
+    inline bool _filtered( uint32_t gid ) const
+    {
+      if( _gidDictionary )
+        return _gidDictionary->test( _filterMask, gid );
+
+      return _filteredGIDs.find( gid ) != _filteredGIDs.end( );
+    }
+
     void updateCachedRep( void );
 
     virtual void resizeEvent( QResizeEvent* event );
@@ -203,6 +221,12 @@ signals:
 
     GIDUSet _filteredGIDs;
 
+    TGIDDictionaryPtr _gidDictionary;
+    TGIDMask _filterMask;
+
+    TSpikeTimeIndexPtr _spikeIndex;
+    SpikePageStore* _spikeStore;
+
     QPoint* _lastMousePosition;
 //    QPoint* _regionPosition;
     float* _regionPercentage;
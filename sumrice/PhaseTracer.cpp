@@ -0,0 +1,151 @@
+/*
+ * @file  PhaseTracer.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include "PhaseTracer.h"
+
+#include <fstream>
+#include <iostream>
+
+namespace visimpl
+{
+  static std::string escapeJSON( const std::string& text )
+  {
+    std::string result;
+    result.reserve( text.size( ));
+
+    for( auto c : text )
+    {
+      if( c == '"' || c == '\\' )
+        result.push_back( '\\' );
+      result.push_back( c );
+    }
+
+    return result;
+  }
+
+  PhaseTracer& PhaseTracer::instance( void )
+  {
+    static PhaseTracer tracer;
+    return tracer;
+  }
+
+  PhaseTracer::PhaseTracer( void )
+  : _enabled( false )
+  , _origin( std::chrono::steady_clock::now( ))
+  { }
+
+  PhaseTracer::~PhaseTracer( void )
+  { }
+
+  void PhaseTracer::enable( const std::string& filePath )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    _filePath = filePath;
+    _enabled = !_filePath.empty( );
+
+    // The enabling thread is reported as the main one.
+    _threadIndex( std::this_thread::get_id( ));
+  }
+
+  unsigned int PhaseTracer::_threadIndex( std::thread::id id )
+  {
+    auto it = _threads.find( id );
+    if( it != _threads.end( ))
+      return it->second;
+
+    unsigned int index = _threads.size( );
+    _threads.insert( std::make_pair( id, index ));
+
+    return index;
+  }
+
+  void PhaseTracer::record( const std::string& name,
+                            const std::string& category,
+                            TTracePoint begin, TTracePoint end )
+  {
+    if( !enabled( ))
+      return;
+
+    TEvent event;
+    event.name = name;
+    event.category = category;
+    event.begin = std::chrono::duration_cast< std::chrono::microseconds >(
+        begin - _origin ).count( );
+    event.duration = std::chrono::duration_cast< std::chrono::microseconds >(
+        end - begin ).count( );
+
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    event.thread = _threadIndex( std::this_thread::get_id( ));
+    _events.push_back( event );
+  }
+
+  bool PhaseTracer::write( void )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    if( _filePath.empty( ))
+      return false;
+
+    std::ofstream file( _filePath );
+    if( !file.is_open( ))
+    {
+      std::cerr << "Could not write trace file " << _filePath << std::endl;
+      return false;
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    for( const auto& thread : _threads )
+    {
+      file << ( first ? "" : "," ) << std::endl
+           << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+           << thread.second << ",\"args\":{\"name\":\""
+           << ( thread.second == 0 ? "main" : "worker" ) << "\"}}";
+      first = false;
+    }
+
+    for( const auto& event : _events )
+    {
+      file << ( first ? "" : "," ) << std::endl
+           << "{\"name\":\"" << escapeJSON( event.name )
+           << "\",\"cat\":\"" << escapeJSON( event.category )
+           << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+           << ",\"ts\":" << event.begin
+           << ",\"dur\":" << event.duration << "}";
+      first = false;
+    }
+
+    file << std::endl << "]}" << std::endl;
+
+    std::cout << "Written " << _events.size( ) << " trace events to "
+              << _filePath << std::endl;
+
+    return true;
+  }
+
+  ScopedPhase::ScopedPhase( const char* name, const char* category )
+  : _name( name )
+  , _category( category )
+  , _active( PhaseTracer::instance( ).enabled( ))
+  {
+    if( _active )
+      _begin = std::chrono::steady_clock::now( );
+  }
+
+  ScopedPhase::~ScopedPhase( void )
+  {
+    if( _active )
+      PhaseTracer::instance( ).record( _name, _category, _begin,
+                                       std::chrono::steady_clock::now( ));
+  }
+
+}
@@ -0,0 +1,91 @@
+/*
+ * @file  PhaseTracer.h
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+#ifndef __VISIMPL_PHASETRACER__
+#define __VISIMPL_PHASETRACER__
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace visimpl
+{
+  typedef std::chrono::steady_clock::time_point TTracePoint;
+
+  /*
+   * Process-wide recorder of timed phases, written as a Chrome trace JSON
+   * file (chrome://tracing, Perfetto). Disabled by default: phases are only
+   * recorded after enable( ) is called with the output path.
+   */
+  class PhaseTracer
+  {
+  public:
+
+    static PhaseTracer& instance( void );
+
+    void enable( const std::string& filePath );
+    inline bool enabled( void ) const
+    {
+      return _enabled.load( std::memory_order_relaxed );
+    }
+
+    void record( const std::string& name, const std::string& category,
+                 TTracePoint begin, TTracePoint end );
+
+    bool write( void );
+
+  protected:
+
+    PhaseTracer( void );
+    ~PhaseTracer( void );
+
+    struct TEvent
+    {
+      std::string name;
+      std::string category;
+      uint64_t begin;
+      uint64_t duration;
+      unsigned int thread;
+    };
+
+    unsigned int _threadIndex( std::thread::id id );
+
+    std::atomic< bool > _enabled;
+    std::string _filePath;
+    TTracePoint _origin;
+
+    std::mutex _mutex;
+    std::vector< TEvent > _events;
+    std::unordered_map< std::thread::id, unsigned int > _threads;
+  };
+
+  /*
+   * Records the lifetime of the object as a phase of the global tracer.
+   */
+  class ScopedPhase
+  {
+  public:
+
+    ScopedPhase( const char* name, const char* category = "startup" );
+    ~ScopedPhase( void );
+
+  protected:
+
+    const char* _name;
+    const char* _category;
+    bool _active;
+    TTracePoint _begin;
+  };
+
+}
+
+#endif /* __VISIMPL_PHASETRACER__ */
@@ -0,0 +1,587 @@
+/*
+ * @file  SpikeCache.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include "SpikeCache.h"
+#include "CSVLoader.h"
+#include "PhaseTracer.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cstring>
+#include <iostream>
+
+#ifdef SIMIL_USE_BRION
+#include <brion/brion.h>
+#endif
+
+namespace visimpl
+{
+  // Bytes hashed at the head and tail of every source file. Hashing the whole
+  // file would cost as much as parsing it.
+  static const qint64 HASH_SAMPLE_SIZE = 1 << 20;
+
+  static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+  static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+  static uint64_t fnv1a( const char* data, size_t size,
+                         uint64_t hash = FNV_OFFSET )
+  {
+    for( size_t i = 0; i < size; ++i )
+    {
+      hash ^= static_cast< unsigned char >( data[ i ]);
+      hash *= FNV_PRIME;
+    }
+    return hash;
+  }
+
+  static uint64_t alignOffset( uint64_t offset )
+  {
+    return ( offset + 7 ) & ~uint64_t( 7 );
+  }
+
+  static void appendBytes( std::vector< char >& blob, const void* data,
+                           size_t size )
+  {
+    const char* bytes = static_cast< const char* >( data );
+    blob.insert( blob.end( ), bytes, bytes + size );
+  }
+
+  static void appendName( std::vector< char >& blob, const std::string& name )
+  {
+    uint64_t size = name.size( );
+    appendBytes( blob, &size, sizeof( uint64_t ));
+    appendBytes( blob, name.data( ), name.size( ));
+  }
+
+  static bool readBytes( const uchar*& cursor, const uchar* end, void* data,
+                         size_t size )
+  {
+    if( static_cast< size_t >( end - cursor ) < size )
+      return false;
+
+    std::memcpy( data, cursor, size );
+    cursor += size;
+    return true;
+  }
+
+  static bool readName( const uchar*& cursor, const uchar* end,
+                        std::string& name )
+  {
+    uint64_t size = 0;
+    if( !readBytes( cursor, end, &size, sizeof( uint64_t )) ||
+        static_cast< uint64_t >( end - cursor ) < size )
+      return false;
+
+    name.assign( reinterpret_cast< const char* >( cursor ), size );
+    cursor += size;
+    return true;
+  }
+
+  // Subsets then events, each as a count followed by name and values.
+  static std::vector< char >
+  packSubsetsEvents( const simil::SubsetEventManager* manager )
+  {
+    std::vector< std::string > subsetNames;
+    std::vector< std::string > eventNames;
+    if( manager )
+    {
+      subsetNames = manager->subsetNames( );
+      eventNames = manager->eventNames( );
+    }
+
+    std::vector< char > blob;
+
+    uint64_t number = subsetNames.size( );
+    appendBytes( blob, &number, sizeof( uint64_t ));
+    for( const auto& name : subsetNames )
+    {
+      GIDVec subset = manager->getSubset( name );
+
+      appendName( blob, name );
+      uint64_t size = subset.size( );
+      appendBytes( blob, &size, sizeof( uint64_t ));
+      appendBytes( blob, subset.data( ), size * sizeof( uint32_t ));
+    }
+
+    number = eventNames.size( );
+    appendBytes( blob, &number, sizeof( uint64_t ));
+    for( const auto& name : eventNames )
+    {
+      EventVec event = manager->getEvent( name );
+
+      appendName( blob, name );
+      uint64_t size = event.size( );
+      appendBytes( blob, &size, sizeof( uint64_t ));
+      for( const auto& frame : event )
+      {
+        float frameTimes[ 2 ] = { frame.first, frame.second };
+        appendBytes( blob, frameTimes, sizeof( frameTimes ));
+      }
+    }
+
+    return blob;
+  }
+
+  SpikeCache::SpikeCache( const std::vector< std::string >& sourceFiles,
+                          simil::TDataType dataType,
+                          const std::string& report )
+  : _sourceFiles( sourceFiles )
+  , _dataType( dataType )
+  , _report( report )
+  , _data( nullptr )
+  , _header( nullptr )
+  {
+    std::string key = std::to_string( static_cast< int >( dataType )) + report;
+    for( auto source : _sourceFiles )
+      key += QFileInfo( QString::fromStdString( source ))
+               .absoluteFilePath( ).toStdString( );
+
+    _filePath = cachePath( key, "spk" );
+  }
+
+  std::string SpikeCache::cachePath( const std::string& key,
+                                     const std::string& extension )
+  {
+    QString cacheDir =
+        QStandardPaths::writableLocation( QStandardPaths::GenericCacheLocation )
+        + "/visimpl";
+
+    QDir( ).mkpath( cacheDir );
+
+    return ( cacheDir + "/" +
+        QString::number( fnv1a( key.data( ), key.size( )), 16 ) + "." +
+        QString::fromStdString( extension )).toStdString( );
+  }
+
+  SpikeCache::~SpikeCache( void )
+  {
+    close( );
+  }
+
+  void SpikeCache::sourceStamp( const std::vector< std::string >& files,
+                                uint64_t& size, int64_t& mtime,
+                                uint64_t& hash )
+  {
+    size = 0;
+    mtime = 0;
+    hash = FNV_OFFSET;
+
+    for( auto source : files )
+    {
+      QFileInfo info( QString::fromStdString( source ));
+      size += info.size( );
+      mtime = std::max( mtime,
+        static_cast< int64_t >( info.lastModified( ).toMSecsSinceEpoch( )));
+
+      QFile file( info.absoluteFilePath( ));
+      if( !file.open( QIODevice::ReadOnly ))
+        continue;
+
+      QByteArray sample = file.read( HASH_SAMPLE_SIZE );
+      hash = fnv1a( sample.constData( ), sample.size( ), hash );
+
+      if( file.size( ) > HASH_SAMPLE_SIZE )
+      {
+        file.seek( std::max( HASH_SAMPLE_SIZE,
+                             file.size( ) - HASH_SAMPLE_SIZE ));
+        sample = file.read( HASH_SAMPLE_SIZE );
+        hash = fnv1a( sample.constData( ), sample.size( ), hash );
+      }
+    }
+  }
+
+  void SpikeCache::_fillSourceStamp( Header& header ) const
+  {
+    sourceStamp( _sourceFiles, header.sourceSize, header.sourceMTime,
+                 header.sourceHash );
+  }
+
+  bool SpikeCache::open( void )
+  {
+    close( );
+
+    _file.setFileName( QString::fromStdString( _filePath ));
+    if( !_file.exists( ) || !_file.open( QIODevice::ReadOnly ))
+      return false;
+
+    if( _file.size( ) < static_cast< qint64 >( sizeof( Header )))
+    {
+      close( );
+      return false;
+    }
+
+    _data = _file.map( 0, _file.size( ));
+    if( !_data )
+    {
+      close( );
+      return false;
+    }
+
+    _header = reinterpret_cast< const Header* >( _data );
+
+    Header stamp;
+    _fillSourceStamp( stamp );
+
+    uint64_t expectedSize = _header->subsetsEventsOffset +
+        _header->subsetsEventsSize;
+
+    if( _header->magic != MAGIC || _header->version != VERSION ||
+        _header->sourceSize != stamp.sourceSize ||
+        _header->sourceMTime != stamp.sourceMTime ||
+        _header->sourceHash != stamp.sourceHash ||
+        static_cast< uint64_t >( _file.size( )) < expectedSize )
+    {
+      std::cout << "Discarding stale spike cache " << _filePath << std::endl;
+      close( );
+      return false;
+    }
+
+    return true;
+  }
+
+  void SpikeCache::close( void )
+  {
+    if( _data )
+      _file.unmap( const_cast< uchar* >( _data ));
+
+    if( _file.isOpen( ))
+      _file.close( );
+
+    _data = nullptr;
+    _header = nullptr;
+  }
+
+  bool SpikeCache::write( simil::SpikeData& spikeData ) const
+  {
+    return write( spikeData.gids( ), spikeData.positions( ),
+                  spikeData.spikes( ), spikeData.startTime( ),
+                  spikeData.endTime( ), spikeData.subsetsEvents( ));
+  }
+
+  bool SpikeCache::write( const TGIDSet& gids, const TPosVect& positions,
+                          const TSpikes& spikes, float startTime,
+                          float endTime,
+                          const simil::SubsetEventManager* subsetEvents ) const
+  {
+    if( positions.size( ) != gids.size( ))
+      return false;
+
+    Header header;
+    std::memset( &header, 0, sizeof( Header ));
+
+    header.magic = MAGIC;
+    header.version = VERSION;
+    _fillSourceStamp( header );
+
+    header.spikesNumber = spikes.size( );
+    header.gidsNumber = gids.size( );
+    header.startTime = startTime;
+    header.endTime = endTime;
+
+    header.timesOffset = alignOffset( sizeof( Header ));
+    header.spikeGidsOffset = alignOffset( header.timesOffset +
+        header.spikesNumber * sizeof( float ));
+    header.gidsOffset = alignOffset( header.spikeGidsOffset +
+        header.spikesNumber * sizeof( uint32_t ));
+    header.positionsOffset = alignOffset( header.gidsOffset +
+        header.gidsNumber * sizeof( uint32_t ));
+
+    std::vector< char > subsetsEvents = packSubsetsEvents( subsetEvents );
+    header.subsetsEventsOffset = alignOffset( header.positionsOffset +
+        header.gidsNumber * 3 * sizeof( float ));
+    header.subsetsEventsSize = subsetsEvents.size( );
+
+    QSaveFile file( QString::fromStdString( _filePath ));
+    if( !file.open( QIODevice::WriteOnly ))
+    {
+      std::cerr << "Could not write spike cache " << _filePath << std::endl;
+      return false;
+    }
+
+    auto pad = [ &file ]( uint64_t offset )
+    {
+      static const char zeros[ 8 ] = { 0 };
+      if( static_cast< uint64_t >( file.pos( )) < offset )
+        file.write( zeros, offset - file.pos( ));
+    };
+
+    file.write( reinterpret_cast< const char* >( &header ), sizeof( Header ));
+
+    std::vector< float > times;
+    std::vector< uint32_t > spikeGids;
+    times.reserve( spikes.size( ));
+    spikeGids.reserve( spikes.size( ));
+    for( auto spike : spikes )
+    {
+      times.push_back( spike.first );
+      spikeGids.push_back( spike.second );
+    }
+
+    pad( header.timesOffset );
+    file.write( reinterpret_cast< const char* >( times.data( )),
+                times.size( ) * sizeof( float ));
+
+    pad( header.spikeGidsOffset );
+    file.write( reinterpret_cast< const char* >( spikeGids.data( )),
+                spikeGids.size( ) * sizeof( uint32_t ));
+
+    std::vector< uint32_t > gidsColumn( gids.begin( ), gids.end( ));
+    pad( header.gidsOffset );
+    file.write( reinterpret_cast< const char* >( gidsColumn.data( )),
+                gidsColumn.size( ) * sizeof( uint32_t ));
+
+    std::vector< float > positionsColumn;
+    positionsColumn.reserve( positions.size( ) * 3 );
+    for( auto position : positions )
+    {
+      positionsColumn.push_back( position.x( ));
+      positionsColumn.push_back( position.y( ));
+      positionsColumn.push_back( position.z( ));
+    }
+    pad( header.positionsOffset );
+    file.write( reinterpret_cast< const char* >( positionsColumn.data( )),
+                positionsColumn.size( ) * sizeof( float ));
+
+    pad( header.subsetsEventsOffset );
+    file.write( subsetsEvents.data( ), subsetsEvents.size( ));
+
+    if( !file.commit( ))
+    {
+      std::cerr << "Could not write spike cache " << _filePath << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  bool SpikeCache::valid( void ) const
+  {
+    return _header != nullptr;
+  }
+
+  const std::string& SpikeCache::filePath( void ) const
+  {
+    return _filePath;
+  }
+
+  uint64_t SpikeCache::spikesNumber( void ) const
+  {
+    return _header ? _header->spikesNumber : 0;
+  }
+
+  uint64_t SpikeCache::gidsNumber( void ) const
+  {
+    return _header ? _header->gidsNumber : 0;
+  }
+
+  float SpikeCache::startTime( void ) const
+  {
+    return _header ? _header->startTime : 0.0f;
+  }
+
+  float SpikeCache::endTime( void ) const
+  {
+    return _header ? _header->endTime : 0.0f;
+  }
+
+  const float* SpikeCache::times( void ) const
+  {
+    return _header ?
+        reinterpret_cast< const float* >( _data + _header->timesOffset ) :
+        nullptr;
+  }
+
+  const uint32_t* SpikeCache::spikeGids( void ) const
+  {
+    return _header ?
+        reinterpret_cast< const uint32_t* >( _data + _header->spikeGidsOffset ) :
+        nullptr;
+  }
+
+  const uint32_t* SpikeCache::gids( void ) const
+  {
+    return _header ?
+        reinterpret_cast< const uint32_t* >( _data + _header->gidsOffset ) :
+        nullptr;
+  }
+
+  const float* SpikeCache::positions( void ) const
+  {
+    return _header ?
+        reinterpret_cast< const float* >( _data + _header->positionsOffset ) :
+        nullptr;
+  }
+
+  simil::SpikeData* SpikeCache::spikeData( void ) const
+  {
+    if( !valid( ))
+      return nullptr;
+
+    const uint64_t spikesNumber_ = spikesNumber( );
+    const uint64_t gidsNumber_ = gidsNumber( );
+
+    const float* times_ = times( );
+    const uint32_t* spikeGids_ = spikeGids( );
+
+    TSpikes spikes;
+    spikes.reserve( spikesNumber_ );
+    for( uint64_t i = 0; i < spikesNumber_; ++i )
+      spikes.emplace_back( times_[ i ], spikeGids_[ i ]);
+
+    const uint32_t* gids_ = gids( );
+    const float* positions_ = positions( );
+
+    TPosVect positionsVec;
+    positionsVec.reserve( gidsNumber_ );
+    for( uint64_t i = 0; i < gidsNumber_; ++i )
+      positionsVec.emplace_back( positions_[ i * 3 ],
+                                 positions_[ i * 3 + 1 ],
+                                 positions_[ i * 3 + 2 ]);
+
+    simil::SpikeData* result = new simil::SpikeData( );
+    result->setGids( TGIDSet( gids_, gids_ + gidsNumber_ ));
+    result->setPositions( positionsVec );
+    result->setSpikes( spikes );
+    result->setStartTime( startTime( ));
+    result->setEndTime( endTime( ));
+
+    exportSubsetsEvents( result->subsetsEvents( ));
+
+    return result;
+  }
+
+  void SpikeCache::exportSubsetsEvents( simil::SubsetEventManager* manager ) const
+  {
+    if( !valid( ) || !manager )
+      return;
+
+    const uchar* cursor = _data + _header->subsetsEventsOffset;
+    const uchar* end = cursor + _header->subsetsEventsSize;
+
+    uint64_t number = 0;
+    if( !readBytes( cursor, end, &number, sizeof( uint64_t )))
+      return;
+
+    for( uint64_t i = 0; i < number; ++i )
+    {
+      std::string name;
+      uint64_t size = 0;
+      if( !readName( cursor, end, name ) ||
+          !readBytes( cursor, end, &size, sizeof( uint64_t )) ||
+          static_cast< uint64_t >( end - cursor ) / sizeof( uint32_t ) < size )
+        return;
+
+      GIDVec subset( size );
+      readBytes( cursor, end, subset.data( ), size * sizeof( uint32_t ));
+
+      manager->addSubset( name, subset );
+    }
+
+    if( !readBytes( cursor, end, &number, sizeof( uint64_t )))
+      return;
+
+    for( uint64_t i = 0; i < number; ++i )
+    {
+      std::string name;
+      uint64_t size = 0;
+      if( !readName( cursor, end, name ) ||
+          !readBytes( cursor, end, &size, sizeof( uint64_t )) ||
+          static_cast< uint64_t >( end - cursor ) / ( 2 * sizeof( float )) < size )
+        return;
+
+      EventVec event;
+      event.reserve( size );
+      for( uint64_t j = 0; j < size; ++j )
+      {
+        float frameTimes[ 2 ];
+        readBytes( cursor, end, frameTimes, sizeof( frameTimes ));
+        event.emplace_back( frameTimes[ 0 ], frameTimes[ 1 ]);
+      }
+
+      manager->addEvent( name, event );
+    }
+  }
+
+  std::vector< std::string >
+  SpikeCache::sourceFiles( const std::string& networkFile,
+                           simil::TDataType dataType,
+                           const std::string& report )
+  {
+    std::vector< std::string > sources = { networkFile };
+
+    // HDF5 and CSV datasets receive the activity file as report.
+    if(( dataType == simil::THDF5 || dataType == simil::TCSV ) &&
+       !report.empty( ))
+      sources.push_back( report );
+
+#ifdef SIMIL_USE_BRION
+    // BlueConfig files only point to the circuit and spike report.
+    if( dataType == simil::TBlueConfig )
+    {
+      try
+      {
+        brion::BlueConfig blueConfig( networkFile );
+        sources.push_back( blueConfig.getCircuitSource( ).getPath( ));
+        sources.push_back( blueConfig.getSpikeSource( ).getPath( ));
+      }
+      catch( const std::exception& e )
+      {
+        std::cerr << "Could not read " << networkFile << ": " << e.what( )
+                  << std::endl;
+      }
+    }
+#endif
+
+    return sources;
+  }
+
+  simil::SpikeData* SpikeCache::load( const std::string& networkFile,
+                                      simil::TDataType dataType,
+                                      const std::string& report )
+  {
+    SpikeCache cache( sourceFiles( networkFile, dataType, report ),
+                      dataType, report );
+
+    if( cache.open( ))
+    {
+      ScopedPhase phase( "Parse cache" );
+
+      std::cout << "Loading spikes from cache " << cache.filePath( )
+                << std::endl;
+      return cache.spikeData( );
+    }
+
+    simil::SpikeData* spikeData = nullptr;
+    if( dataType == simil::TCSV )
+    {
+      spikeData = CSVLoader::load( networkFile, report );
+    }
+    else
+    {
+      {
+        ScopedPhase phase( "Parse" );
+        spikeData = new simil::SpikeData( networkFile, dataType, report );
+      }
+      {
+        ScopedPhase phase( "reduceDataToGIDS" );
+        spikeData->reduceDataToGIDS( );
+      }
+    }
+
+    if( cache.write( *spikeData ))
+      std::cout << "Stored spike cache " << cache.filePath( ) << std::endl;
+
+    return spikeData;
+  }
+
+}
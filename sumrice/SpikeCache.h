@@ -0,0 +1,131 @@
+/*
+ * @file  SpikeCache.h
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+#ifndef __VISIMPL_SPIKECACHE__
+#define __VISIMPL_SPIKECACHE__
+
+#include <string>
+#include <vector>
+
+#include <QFile>
+
+#include <simil/simil.h>
+
+#include "types.h"
+
+namespace visimpl
+{
+
+  /*
+   * Columnar on-disk copy of a parsed spike dataset. Spike times, spike gids,
+   * network gids and network positions are stored as contiguous arrays after
+   * a fixed header, followed by the dataset subsets and events, so later
+   * loads only need to map the file and copy the columns back instead of
+   * re-parsing the original sources. Caches live in
+   * the generic cache location so visimpl and stackviz share them (and the
+   * OS page cache).
+   */
+  class SpikeCache
+  {
+  public:
+
+    static const uint32_t MAGIC = 0x4B505356; // "VSPK"
+    static const uint32_t VERSION = 2;
+
+    struct Header
+    {
+      uint32_t magic;
+      uint32_t version;
+
+      uint64_t sourceSize;
+      int64_t sourceMTime;
+      uint64_t sourceHash;
+
+      uint64_t spikesNumber;
+      uint64_t gidsNumber;
+
+      float startTime;
+      float endTime;
+
+      uint64_t timesOffset;
+      uint64_t spikeGidsOffset;
+      uint64_t gidsOffset;
+      uint64_t positionsOffset;
+      uint64_t subsetsEventsOffset;
+      uint64_t subsetsEventsSize;
+    };
+
+    SpikeCache( const std::vector< std::string >& sourceFiles,
+                simil::TDataType dataType,
+                const std::string& report = "" );
+    ~SpikeCache( void );
+
+    // Maps the cache file if present and still matching its sources.
+    bool open( void );
+    void close( void );
+
+    bool write( simil::SpikeData& spikeData ) const;
+    bool write( const TGIDSet& gids, const TPosVect& positions,
+                const TSpikes& spikes, float startTime, float endTime,
+                const simil::SubsetEventManager* subsetEvents = nullptr ) const;
+
+    bool valid( void ) const;
+    const std::string& filePath( void ) const;
+
+    uint64_t spikesNumber( void ) const;
+    uint64_t gidsNumber( void ) const;
+    float startTime( void ) const;
+    float endTime( void ) const;
+
+    const float* times( void ) const;
+    const uint32_t* spikeGids( void ) const;
+    const uint32_t* gids( void ) const;
+    const float* positions( void ) const;
+
+    simil::SpikeData* spikeData( void ) const;
+
+    // Adds the cached subsets and events to manager.
+    void exportSubsetsEvents( simil::SubsetEventManager* manager ) const;
+
+    static std::vector< std::string >
+    sourceFiles( const std::string& networkFile, simil::TDataType dataType,
+                 const std::string& report = "" );
+
+    // Returns the cached dataset when fresh, otherwise parses the sources
+    // and stores a new cache for the next session.
+    static simil::SpikeData* load( const std::string& networkFile,
+                                   simil::TDataType dataType,
+                                   const std::string& report = "" );
+
+    // Size, latest modification time and sampled hash of the given files,
+    // used to detect stale cache files.
+    static void sourceStamp( const std::vector< std::string >& files,
+                             uint64_t& size, int64_t& mtime, uint64_t& hash );
+
+    // File in the shared cache directory identified by key.
+    static std::string cachePath( const std::string& key,
+                                  const std::string& extension );
+
+  protected:
+
+    void _fillSourceStamp( Header& header ) const;
+
+    std::vector< std::string > _sourceFiles;
+    simil::TDataType _dataType;
+    std::string _report;
+
+    std::string _filePath;
+
+    QFile _file;
+    const uchar* _data;
+    const Header* _header;
+  };
+
+}
+
+#endif /* __VISIMPL_SPIKECACHE__ */
@@ -0,0 +1,180 @@
+/*
+ * @file  SpikePageStore.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include "SpikePageStore.h"
+
+#include <algorithm>
+
+namespace visimpl
+{
+  SpikePageStore::SpikePageStore( const std::vector< std::string >& sourceFiles,
+                                  simil::TDataType dataType,
+                                  const std::string& report,
+                                  size_t memoryBudget_ )
+  : _cache( sourceFiles, dataType, report )
+  , _memoryBudget( memoryBudget_ )
+  , _times( nullptr )
+  , _gids( nullptr )
+  , _spikesNumber( 0 )
+  { }
+
+  bool SpikePageStore::open( void )
+  {
+    _lru.clear( );
+    _pages.clear( );
+    _pageStartTimes.clear( );
+
+    if( !_cache.open( ))
+      return false;
+
+    _times = _cache.times( );
+    _gids = _cache.spikeGids( );
+    _spikesNumber = _cache.spikesNumber( );
+
+    // Only the first time of every page is touched here, the rest of the
+    // mapped file is faulted in on demand.
+    uint64_t pagesNumber =
+        ( _spikesNumber + SPIKES_PER_PAGE - 1 ) / SPIKES_PER_PAGE;
+    _pageStartTimes.reserve( pagesNumber );
+    for( uint64_t i = 0; i < pagesNumber; ++i )
+      _pageStartTimes.push_back( _times[ i * SPIKES_PER_PAGE ]);
+
+    return true;
+  }
+
+  void SpikePageStore::memoryBudget( size_t bytes )
+  {
+    _memoryBudget = bytes;
+    _evict( 1, 0 );
+  }
+
+  size_t SpikePageStore::memoryBudget( void ) const
+  {
+    return _memoryBudget;
+  }
+
+  size_t SpikePageStore::pageBytes( void )
+  {
+    return SPIKES_PER_PAGE * sizeof( Spike );
+  }
+
+  size_t SpikePageStore::residentBytes( void ) const
+  {
+    return _pages.size( ) * pageBytes( );
+  }
+
+  uint64_t SpikePageStore::spikesNumber( void ) const
+  {
+    return _spikesNumber;
+  }
+
+  float SpikePageStore::startTime( void ) const
+  {
+    return _cache.startTime( );
+  }
+
+  float SpikePageStore::endTime( void ) const
+  {
+    return _cache.endTime( );
+  }
+
+  uint64_t SpikePageStore::lowerBound( float time ) const
+  {
+    if( _pageStartTimes.empty( ))
+      return 0;
+
+    // Last page starting before time, then search inside its mapped range.
+    auto pageIt = std::lower_bound( _pageStartTimes.begin( ),
+                                    _pageStartTimes.end( ), time );
+    uint64_t pageIdx = pageIt - _pageStartTimes.begin( );
+    if( pageIdx > 0 )
+      --pageIdx;
+
+    const float* first = _times + pageIdx * SPIKES_PER_PAGE;
+    const float* last = _times + std::min( _spikesNumber,
+                                           ( pageIdx + 2 ) * SPIKES_PER_PAGE );
+
+    return std::lower_bound( first, last, time ) - _times;
+  }
+
+  const TSpikes& SpikePageStore::_page( uint64_t pageIdx )
+  {
+    auto it = _pages.find( pageIdx );
+    if( it != _pages.end( ))
+    {
+      _lru.splice( _lru.begin( ), _lru, it->second.second );
+      return it->second.first;
+    }
+
+    uint64_t first = pageIdx * SPIKES_PER_PAGE;
+    uint64_t last = std::min( first + SPIKES_PER_PAGE, _spikesNumber );
+
+    TSpikes spikes;
+    spikes.reserve( last - first );
+    for( uint64_t i = first; i < last; ++i )
+      spikes.emplace_back( _times[ i ], _gids[ i ]);
+
+    _lru.push_front( pageIdx );
+    auto& page = _pages[ pageIdx ];
+    page.first = std::move( spikes );
+    page.second = _lru.begin( );
+
+    return page.first;
+  }
+
+  void SpikePageStore::_evict( uint64_t keepFirst, uint64_t keepLast )
+  {
+    while( !_lru.empty( ) && residentBytes( ) > _memoryBudget )
+    {
+      uint64_t pageIdx = _lru.back( );
+      if( pageIdx >= keepFirst && pageIdx <= keepLast )
+        break;
+
+      _pages.erase( pageIdx );
+      _lru.pop_back( );
+    }
+  }
+
+  void SpikePageStore::visitSpikes( float begin, float end,
+      const std::function< void( const simil::SpikesCRange& )>& visitor )
+  {
+    if( _spikesNumber == 0 || end <= begin )
+      return;
+
+    uint64_t first = lowerBound( begin );
+    uint64_t last = lowerBound( end );
+    if( first >= last )
+      return;
+
+    uint64_t pageIdx = first / SPIKES_PER_PAGE;
+    while( first < last )
+    {
+      pageIdx = first / SPIKES_PER_PAGE;
+      uint64_t pageFirst = pageIdx * SPIKES_PER_PAGE;
+
+      const TSpikes& page = _page( pageIdx );
+      uint64_t to = std::min( last, pageFirst + page.size( ));
+
+      visitor( std::make_pair( page.cbegin( ) + ( first - pageFirst ),
+                               page.cbegin( ) + ( to - pageFirst )));
+
+      _evict( pageIdx, pageIdx );
+
+      first = to;
+    }
+
+    // Read ahead of the playhead.
+    if(( pageIdx + 1 ) * SPIKES_PER_PAGE < _spikesNumber )
+    {
+      _page( pageIdx + 1 );
+      _evict( pageIdx, pageIdx + 1 );
+    }
+  }
+
+}
@@ -0,0 +1,85 @@
+/*
+ * @file  SpikePageStore.h
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+#ifndef __VISIMPL_SPIKEPAGESTORE__
+#define __VISIMPL_SPIKEPAGESTORE__
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+#include <simil/simil.h>
+
+#include "types.h"
+#include "SpikeCache.h"
+
+namespace visimpl
+{
+
+  /*
+   * Time-paged access to the spikes of a cache file that does not fit in
+   * memory. Spikes are decoded in fixed-size pages kept in an LRU bounded by
+   * the memory budget. visitSpikes( ) hands the spikes in [ begin, end ) to
+   * the visitor in time order, one page at a time, so ranges of any length
+   * are walked without copying them. Ranges are only valid during the
+   * visitor call.
+   */
+  class SpikePageStore
+  {
+  public:
+
+    static const uint64_t SPIKES_PER_PAGE = 1 << 18;
+
+    SpikePageStore( const std::vector< std::string >& sourceFiles,
+                    simil::TDataType dataType,
+                    const std::string& report = "",
+                    size_t memoryBudget = 256 * 1024 * 1024 );
+
+    bool open( void );
+
+    void memoryBudget( size_t bytes );
+    size_t memoryBudget( void ) const;
+
+    size_t residentBytes( void ) const;
+    uint64_t spikesNumber( void ) const;
+
+    float startTime( void ) const;
+    float endTime( void ) const;
+
+    // Index of the first spike at or after time, without decoding pages.
+    uint64_t lowerBound( float time ) const;
+
+    void visitSpikes( float begin, float end,
+                      const std::function< void( const simil::SpikesCRange& )>&
+                        visitor );
+
+    static size_t pageBytes( void );
+
+  protected:
+
+    typedef std::pair< TSpikes, std::list< uint64_t >::iterator > TPage;
+
+    const TSpikes& _page( uint64_t pageIdx );
+    void _evict( uint64_t keepFirst, uint64_t keepLast );
+
+    SpikeCache _cache;
+    size_t _memoryBudget;
+
+    const float* _times;
+    const uint32_t* _gids;
+    uint64_t _spikesNumber;
+
+    std::vector< float > _pageStartTimes;
+
+    std::list< uint64_t > _lru;
+    std::unordered_map< uint64_t, TPage > _pages;
+  };
+
+}
+
+#endif /* __VISIMPL_SPIKEPAGESTORE__ */
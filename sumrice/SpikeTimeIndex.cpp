@@ -0,0 +1,139 @@
+/*
+ * @file  SpikeTimeIndex.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include "SpikeTimeIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace visimpl
+{
+  SpikeTimeIndex::SpikeTimeIndex( const TSpikes& spikes, float startTime,
+                                  float endTime, float quantum_ )
+  : _spikes( &spikes )
+  , _startTime( startTime )
+  , _endTime( endTime )
+  , _fixedQuantum( quantum_ > 0.0f )
+  , _quantum( quantum_ )
+  , _indexed( 0 )
+  , _lastTime( startTime )
+  {
+    if( !_fixedQuantum )
+      _quantum = _autoQuantum( spikes.size( ),
+                               spikes.empty( ) ? endTime : spikes.back( ).first );
+
+    _invQuantum = 1.0f / _quantum;
+
+    update( );
+  }
+
+  int64_t SpikeTimeIndex::_bucket( float time ) const
+  {
+    return std::max( int64_t( 0 ),
+        int64_t( std::floor(( time - _startTime ) * _invQuantum )));
+  }
+
+  float SpikeTimeIndex::_autoQuantum( uint64_t spikes, float lastTime ) const
+  {
+    uint64_t buckets = std::max( uint64_t( MIN_BUCKETS ),
+                                 spikes / SPIKES_PER_BUCKET );
+
+    return std::max( std::max( _endTime, lastTime ) - _startTime, 1.0f ) /
+        buckets;
+  }
+
+  void SpikeTimeIndex::_quantumChange( float quantum_ )
+  {
+    _quantum = quantum_;
+    _invQuantum = 1.0f / _quantum;
+
+    _offsets.clear( );
+    _indexed = 0;
+    _lastTime = _startTime;
+  }
+
+  void SpikeTimeIndex::update( void )
+  {
+    const TSpikes& spikes = *_spikes;
+
+    // Loading progressively the span and count are unknown up front. Both
+    // only grow, so rebuilding on a constant factor drift stays linear.
+    if( !_fixedQuantum && !spikes.empty( ))
+    {
+      float quantum_ = _autoQuantum( spikes.size( ), spikes.back( ).first );
+      if( quantum_ > _quantum * REBUCKET_FACTOR ||
+          quantum_ * REBUCKET_FACTOR < _quantum )
+        _quantumChange( quantum_ );
+    }
+
+    // Spikes inserted before the indexed ones invalidate the offsets.
+    if( _indexed > spikes.size( ) ||
+        ( _indexed < spikes.size( ) && spikes[ _indexed ].first < _lastTime ))
+    {
+      _offsets.clear( );
+      _indexed = 0;
+      _lastTime = _startTime;
+    }
+
+    for( uint64_t i = _indexed; i < spikes.size( ); ++i )
+    {
+      uint64_t bucket = _bucket( spikes[ i ].first );
+      if( bucket >= _offsets.size( ))
+        _offsets.resize( bucket + 1, i );
+    }
+
+    _indexed = spikes.size( );
+    if( _indexed > 0 )
+      _lastTime = spikes[ _indexed - 1 ].first;
+  }
+
+  uint64_t SpikeTimeIndex::lowerBound( float time ) const
+  {
+    uint64_t bucket = _bucket( time );
+    if( bucket >= _offsets.size( ))
+      return _indexed;
+
+    // Spikes of earlier buckets are before time and spikes of later ones
+    // after it, only this bucket needs a search.
+    auto first = _spikes->begin( ) + _offsets[ bucket ];
+    auto last = _spikes->begin( ) + ( bucket + 1 < _offsets.size( ) ?
+                                      _offsets[ bucket + 1 ] : _indexed );
+
+    return std::lower_bound( first, last, time,
+                             []( const Spike& spike, float value )
+                             { return spike.first < value; }) -
+        _spikes->begin( );
+  }
+
+  simil::SpikesCRange SpikeTimeIndex::spikesBetween( float begin,
+                                                     float end ) const
+  {
+    auto first = _spikes->cbegin( ) + lowerBound( begin );
+    if( end <= begin )
+      return std::make_pair( first, first );
+
+    return std::make_pair( first, _spikes->cbegin( ) + lowerBound( end ));
+  }
+
+  const TSpikes& SpikeTimeIndex::spikes( void ) const
+  {
+    return *_spikes;
+  }
+
+  uint64_t SpikeTimeIndex::indexedSpikes( void ) const
+  {
+    return _indexed;
+  }
+
+  float SpikeTimeIndex::quantum( void ) const
+  {
+    return _quantum;
+  }
+
+}
@@ -0,0 +1,81 @@
+/*
+ * @file  SpikeTimeIndex.h
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+#ifndef __VISIMPL_SPIKETIMEINDEX__
+#define __VISIMPL_SPIKETIMEINDEX__
+
+#include <memory>
+#include <vector>
+
+#include <simil/simil.h>
+
+#include "types.h"
+
+namespace visimpl
+{
+
+  /*
+   * Offset of the first spike of every fixed time quantum of a time-sorted
+   * spike container. Seeks land on their bucket directly and only search
+   * inside it, so range queries cost the size of the result. Offsets are
+   * kept instead of iterators: spikes appended to the container are indexed
+   * by update( ) even if it reallocated. An automatic quantum follows the
+   * spike count and time span as they grow, the index is rebuilt when the
+   * spikes per bucket drift too far from SPIKES_PER_BUCKET.
+   */
+  class SpikeTimeIndex
+  {
+  public:
+
+    // Average spikes per bucket when the quantum is chosen automatically.
+    static const unsigned int SPIKES_PER_BUCKET = 64;
+    static const unsigned int MIN_BUCKETS = 1024;
+    static const unsigned int REBUCKET_FACTOR = 4;
+
+    SpikeTimeIndex( const TSpikes& spikes, float startTime, float endTime,
+                    float quantum = 0.0f );
+
+    // Indexes spikes appended since the last call.
+    void update( void );
+
+    // First spike at or after time.
+    uint64_t lowerBound( float time ) const;
+
+    // Spikes in [ begin, end ), same as SpikesPlayer::spikesBetween.
+    simil::SpikesCRange spikesBetween( float begin, float end ) const;
+
+    const TSpikes& spikes( void ) const;
+    uint64_t indexedSpikes( void ) const;
+    float quantum( void ) const;
+
+  protected:
+
+    int64_t _bucket( float time ) const;
+    float _autoQuantum( uint64_t spikes, float lastTime ) const;
+    void _quantumChange( float quantum );
+
+    const TSpikes* _spikes;
+
+    float _startTime;
+    float _endTime;
+    bool _fixedQuantum;
+    float _quantum;
+    float _invQuantum;
+
+    uint64_t _indexed;
+    float _lastTime;
+
+    // _offsets[ b ] is the first spike whose bucket is b or later.
+    std::vector< uint64_t > _offsets;
+  };
+
+  typedef std::shared_ptr< SpikeTimeIndex > TSpikeTimeIndexPtr;
+
+}
+
+#endif /* __VISIMPL_SPIKETIMEINDEX__ */
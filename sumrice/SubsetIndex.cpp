@@ -0,0 +1,715 @@
+/*
+ * @file  SubsetIndex.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include "SubsetIndex.h"
+#include "SpikeCache.h"
+#include "PhaseTracer.h"
+
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace visimpl
+{
+  static uint64_t alignOffset( uint64_t offset )
+  {
+    return ( offset + 7 ) & ~uint64_t( 7 );
+  }
+
+  /*
+   * Single pass reader for subset/event JSON files. Accepts sections as
+   * arrays of objects ( { "name": ..., "gids": [ ... ] },
+   * { "name": ..., "timeFrames": [ [ start, end ], ... ] } ) or as objects
+   * keyed by name. Values are appended to flat arrays as they are read, no
+   * document tree is built.
+   */
+  class SubsetJSONReader
+  {
+  public:
+
+    SubsetJSONReader( const char* begin, const char* end )
+    : _it( begin )
+    , _end( end )
+    { }
+
+    bool parse( void )
+    {
+      subsetOffsets.assign( 1, 0 );
+      eventOffsets.assign( 1, 0 );
+
+      if( !_consume( '{' ))
+        return false;
+
+      if( _consume( '}' ))
+        return true;
+
+      do
+      {
+        std::string key;
+        if( !_string( key ) || !_consume( ':' ))
+          return false;
+
+        bool result;
+        if( key == "subsets" )
+          result = _section( true );
+        else if( key == "events" )
+          result = _section( false );
+        else
+          result = _skipValue( );
+
+        if( !result )
+          return false;
+      }
+      while( _consume( ',' ));
+
+      return _consume( '}' );
+    }
+
+    size_t position( const char* begin ) const
+    {
+      return _it - begin;
+    }
+
+    std::vector< std::string > subsetNames;
+    std::vector< uint64_t > subsetOffsets;
+    std::vector< uint32_t > gids;
+
+    std::vector< std::string > eventNames;
+    std::vector< uint64_t > eventOffsets;
+    std::vector< float > frames;
+
+  protected:
+
+    void _skipSpaces( void )
+    {
+      while( _it < _end && ( *_it == ' ' || *_it == '\n' ||
+                             *_it == '\r' || *_it == '\t' ))
+        ++_it;
+    }
+
+    char _peek( void )
+    {
+      _skipSpaces( );
+      return _it < _end ? *_it : '\0';
+    }
+
+    bool _consume( char c )
+    {
+      if( _peek( ) != c )
+        return false;
+
+      ++_it;
+      return true;
+    }
+
+    bool _string( std::string& result )
+    {
+      if( !_consume( '"' ))
+        return false;
+
+      result.clear( );
+      while( _it < _end && *_it != '"' )
+      {
+        if( *_it == '\\' && _it + 1 < _end )
+          ++_it;
+        result.push_back( *_it );
+        ++_it;
+      }
+
+      if( _it >= _end )
+        return false;
+
+      ++_it;
+      return true;
+    }
+
+    bool _number( double& result )
+    {
+      _skipSpaces( );
+
+      char buffer[ 64 ];
+      size_t size = 0;
+      while( _it < _end && size < sizeof( buffer ) - 1 &&
+             ( std::isdigit( static_cast< unsigned char >( *_it )) ||
+               *_it == '-' || *_it == '+' || *_it == '.' ||
+               *_it == 'e' || *_it == 'E' ))
+        buffer[ size++ ] = *_it++;
+
+      if( size == 0 )
+        return false;
+
+      buffer[ size ] = '\0';
+      result = std::strtod( buffer, nullptr );
+      return true;
+    }
+
+    bool _gid( uint32_t& result )
+    {
+      _skipSpaces( );
+
+      // Plain integers are by far the common case.
+      const char* start = _it;
+      uint64_t value = 0;
+      while( _it < _end && *_it >= '0' && *_it <= '9' )
+        value = value * 10 + ( *_it++ - '0' );
+
+      if( _it < _end && ( *_it == '.' || *_it == 'e' || *_it == 'E' ))
+      {
+        _it = start;
+        double number;
+        if( !_number( number ))
+          return false;
+        value = number;
+      }
+      else if( _it == start )
+      {
+        return false;
+      }
+
+      result = value;
+      return true;
+    }
+
+    bool _skipValue( void )
+    {
+      char c = _peek( );
+
+      if( c == '"' )
+      {
+        std::string dummy;
+        return _string( dummy );
+      }
+
+      if( c == '{' || c == '[' )
+      {
+        // Strings may contain brackets, track them while skipping.
+        unsigned int depth = 0;
+        do
+        {
+          if( *_it == '"' )
+          {
+            std::string dummy;
+            if( !_string( dummy ))
+              return false;
+            continue;
+          }
+
+          if( *_it == '{' || *_it == '[' )
+            ++depth;
+          else if( *_it == '}' || *_it == ']' )
+            --depth;
+
+          ++_it;
+        }
+        while( depth > 0 && _it < _end );
+
+        return depth == 0;
+      }
+
+      // Numbers, booleans and null.
+      while( _it < _end && *_it != ',' && *_it != '}' && *_it != ']' )
+        ++_it;
+
+      return true;
+    }
+
+    bool _section( bool subsets )
+    {
+      char c = _peek( );
+
+      if( c == '[' )
+      {
+        ++_it;
+        if( _consume( ']' ))
+          return true;
+
+        do
+        {
+          if( !_namedEntry( subsets ))
+            return false;
+        }
+        while( _consume( ',' ));
+
+        return _consume( ']' );
+      }
+
+      if( c == '{' )
+      {
+        ++_it;
+        if( _consume( '}' ))
+          return true;
+
+        do
+        {
+          std::string name;
+          if( !_string( name ) || !_consume( ':' ) ||
+              !( subsets ? _gidArray( ) : _frameArray( )))
+            return false;
+
+          _closeEntry( subsets, name );
+        }
+        while( _consume( ',' ));
+
+        return _consume( '}' );
+      }
+
+      return _skipValue( );
+    }
+
+    bool _namedEntry( bool subsets )
+    {
+      if( !_consume( '{' ))
+        return false;
+
+      std::string name;
+      if( !_consume( '}' ))
+      {
+        do
+        {
+          std::string key;
+          if( !_string( key ) || !_consume( ':' ))
+            return false;
+
+          // Any other key, arrays included, is not part of the index.
+          bool result;
+          if( key == "name" )
+            result = _string( name );
+          else if( subsets && key == "gids" )
+            result = _gidArray( );
+          else if( !subsets && key == "timeFrames" )
+            result = _frameArray( );
+          else
+            result = _skipValue( );
+
+          if( !result )
+            return false;
+        }
+        while( _consume( ',' ));
+
+        if( !_consume( '}' ))
+          return false;
+      }
+
+      _closeEntry( subsets, name );
+      return true;
+    }
+
+    void _closeEntry( bool subsets, const std::string& name )
+    {
+      if( subsets )
+      {
+        subsetNames.push_back( name );
+        subsetOffsets.push_back( gids.size( ));
+      }
+      else
+      {
+        eventNames.push_back( name );
+        eventOffsets.push_back( frames.size( ) / 2 );
+      }
+    }
+
+    bool _gidArray( void )
+    {
+      if( !_consume( '[' ))
+        return false;
+
+      if( _consume( ']' ))
+        return true;
+
+      do
+      {
+        uint32_t gid;
+        if( !_gid( gid ))
+          return false;
+        gids.push_back( gid );
+      }
+      while( _consume( ',' ));
+
+      return _consume( ']' );
+    }
+
+    // Frames as [ [ start, end ], ... ], [ { "start", "end" }, ... ] or
+    // a flat [ start, end, ... ] list.
+    bool _frameArray( void )
+    {
+      if( !_consume( '[' ))
+        return false;
+
+      if( _consume( ']' ))
+        return true;
+
+      do
+      {
+        char c = _peek( );
+        double start = 0.0;
+        double end = 0.0;
+
+        if( c == '[' )
+        {
+          ++_it;
+          if( !_number( start ) || !_consume( ',' ) || !_number( end ) ||
+              !_consume( ']' ))
+            return false;
+        }
+        else if( c == '{' )
+        {
+          ++_it;
+          do
+          {
+            std::string key;
+            double value;
+            if( !_string( key ) || !_consume( ':' ) || !_number( value ))
+              return false;
+
+            if( key == "start" || key == "begin" )
+              start = value;
+            else if( key == "end" )
+              end = value;
+          }
+          while( _consume( ',' ));
+
+          if( !_consume( '}' ))
+            return false;
+        }
+        else
+        {
+          if( !_number( start ) || !_consume( ',' ) || !_number( end ))
+            return false;
+        }
+
+        frames.push_back( start );
+        frames.push_back( end );
+      }
+      while( _consume( ',' ));
+
+      return _consume( ']' );
+    }
+
+    const char* _it;
+    const char* _end;
+  };
+
+  SubsetIndex::SubsetIndex( const std::string& sourceFile )
+  : _sourceFile( QFileInfo( QString::fromStdString( sourceFile ))
+                 .absoluteFilePath( ).toStdString( ))
+  , _filePath( SpikeCache::cachePath( _sourceFile, "ssi" ))
+  , _data( nullptr )
+  , _header( nullptr )
+  { }
+
+  SubsetIndex::~SubsetIndex( void )
+  {
+    close( );
+  }
+
+  bool SubsetIndex::open( void )
+  {
+    close( );
+
+    _file.setFileName( QString::fromStdString( _filePath ));
+    if( !_file.exists( ) || !_file.open( QIODevice::ReadOnly ))
+      return false;
+
+    if( _file.size( ) < static_cast< qint64 >( sizeof( Header )))
+    {
+      close( );
+      return false;
+    }
+
+    _data = _file.map( 0, _file.size( ));
+    if( !_data )
+    {
+      close( );
+      return false;
+    }
+
+    _header = reinterpret_cast< const Header* >( _data );
+
+    uint64_t sourceSize;
+    int64_t sourceMTime;
+    uint64_t sourceHash;
+    SpikeCache::sourceStamp( { _sourceFile }, sourceSize, sourceMTime,
+                             sourceHash );
+
+    if( _header->magic != MAGIC || _header->version != VERSION ||
+        _header->sourceSize != sourceSize ||
+        _header->sourceMTime != sourceMTime ||
+        _header->sourceHash != sourceHash ||
+        static_cast< uint64_t >( _file.size( )) < _header->framesOffset )
+    {
+      std::cout << "Discarding stale subset index " << _filePath << std::endl;
+      close( );
+      return false;
+    }
+
+    return true;
+  }
+
+  void SubsetIndex::close( void )
+  {
+    if( _data )
+      _file.unmap( const_cast< uchar* >( _data ));
+
+    if( _file.isOpen( ))
+      _file.close( );
+
+    _data = nullptr;
+    _header = nullptr;
+  }
+
+  bool SubsetIndex::build( void )
+  {
+    ScopedPhase phase( "Parse subsets" );
+
+    close( );
+
+    QFile source( QString::fromStdString( _sourceFile ));
+    if( !source.open( QIODevice::ReadOnly ))
+    {
+      std::cerr << "Could not open subset file " << _sourceFile << std::endl;
+      return false;
+    }
+
+    const char* begin =
+        reinterpret_cast< const char* >( source.map( 0, source.size( )));
+    if( !begin )
+    {
+      std::cerr << "Could not map subset file " << _sourceFile << std::endl;
+      return false;
+    }
+
+    SubsetJSONReader reader( begin, begin + source.size( ));
+    bool parsed = reader.parse( );
+
+    if( !parsed )
+      std::cerr << "Error parsing " << _sourceFile << " near byte "
+                << reader.position( begin ) << std::endl;
+
+    source.unmap( reinterpret_cast< uchar* >( const_cast< char* >( begin )));
+
+    if( !parsed )
+      return false;
+
+    // Sorted, unique gids per subset; frames sorted by start time.
+    auto& gids = reader.gids;
+    auto& subsetOffsets = reader.subsetOffsets;
+    uint64_t written = 0;
+    for( unsigned int i = 0; i + 1 < subsetOffsets.size( ); ++i )
+    {
+      auto first = gids.begin( ) + subsetOffsets[ i ];
+      auto last = gids.begin( ) + subsetOffsets[ i + 1 ];
+
+      std::sort( first, last );
+      last = std::unique( first, last );
+
+      subsetOffsets[ i ] = written;
+      written = std::copy( first, last, gids.begin( ) + written ) -
+          gids.begin( );
+    }
+    subsetOffsets.back( ) = written;
+    gids.resize( written );
+
+    auto& frames = reader.frames;
+    typedef std::pair< float, float > TFrame;
+    for( unsigned int i = 0; i + 1 < reader.eventOffsets.size( ); ++i )
+    {
+      TFrame* first = reinterpret_cast< TFrame* >(
+          frames.data( ) + reader.eventOffsets[ i ] * 2 );
+      TFrame* last = reinterpret_cast< TFrame* >(
+          frames.data( ) + reader.eventOffsets[ i + 1 ] * 2 );
+      std::sort( first, last );
+    }
+
+    std::vector< uint64_t > nameOffsets( 1, 0 );
+    std::string names;
+    for( const auto& name : reader.subsetNames )
+    {
+      names.append( name.c_str( ), name.size( ) + 1 );
+      nameOffsets.push_back( names.size( ));
+    }
+    for( const auto& name : reader.eventNames )
+    {
+      names.append( name.c_str( ), name.size( ) + 1 );
+      nameOffsets.push_back( names.size( ));
+    }
+
+    Header header;
+    std::memset( &header, 0, sizeof( Header ));
+
+    header.magic = MAGIC;
+    header.version = VERSION;
+    SpikeCache::sourceStamp( { _sourceFile }, header.sourceSize,
+                             header.sourceMTime, header.sourceHash );
+
+    header.subsetsNumber = reader.subsetNames.size( );
+    header.eventsNumber = reader.eventNames.size( );
+
+    header.nameOffsetsOffset = alignOffset( sizeof( Header ));
+    header.namesOffset = alignOffset( header.nameOffsetsOffset +
+        nameOffsets.size( ) * sizeof( uint64_t ));
+    header.subsetOffsetsOffset =
+        alignOffset( header.namesOffset + names.size( ));
+    header.gidsOffset = alignOffset( header.subsetOffsetsOffset +
+        subsetOffsets.size( ) * sizeof( uint64_t ));
+    header.eventOffsetsOffset = alignOffset( header.gidsOffset +
+        gids.size( ) * sizeof( uint32_t ));
+    header.framesOffset = alignOffset( header.eventOffsetsOffset +
+        reader.eventOffsets.size( ) * sizeof( uint64_t ));
+
+    QSaveFile file( QString::fromStdString( _filePath ));
+    if( !file.open( QIODevice::WriteOnly ))
+    {
+      std::cerr << "Could not write subset index " << _filePath << std::endl;
+      return false;
+    }
+
+    auto writeAt = [ &file ]( uint64_t offset, const void* data,
+                              uint64_t size )
+    {
+      static const char padding[ 8 ] = { 0 };
+      if( file.pos( ) < static_cast< qint64 >( offset ))
+        file.write( padding, offset - file.pos( ));
+      file.write( reinterpret_cast< const char* >( data ), size );
+    };
+
+    writeAt( 0, &header, sizeof( Header ));
+    writeAt( header.nameOffsetsOffset, nameOffsets.data( ),
+             nameOffsets.size( ) * sizeof( uint64_t ));
+    writeAt( header.namesOffset, names.data( ), names.size( ));
+    writeAt( header.subsetOffsetsOffset, subsetOffsets.data( ),
+             subsetOffsets.size( ) * sizeof( uint64_t ));
+    writeAt( header.gidsOffset, gids.data( ),
+             gids.size( ) * sizeof( uint32_t ));
+    writeAt( header.eventOffsetsOffset, reader.eventOffsets.data( ),
+             reader.eventOffsets.size( ) * sizeof( uint64_t ));
+    writeAt( header.framesOffset, frames.data( ),
+             frames.size( ) * sizeof( float ));
+
+    if( !file.commit( ))
+    {
+      std::cerr << "Could not write subset index " << _filePath << std::endl;
+      return false;
+    }
+
+    std::cout << "Indexed " << header.subsetsNumber << " subsets ("
+              << gids.size( ) << " gids) and " << header.eventsNumber
+              << " events into " << _filePath << std::endl;
+
+    return open( );
+  }
+
+  bool SubsetIndex::valid( void ) const
+  {
+    return _header != nullptr;
+  }
+
+  const std::string& SubsetIndex::filePath( void ) const
+  {
+    return _filePath;
+  }
+
+  uint64_t SubsetIndex::subsetsNumber( void ) const
+  {
+    return _header ? _header->subsetsNumber : 0;
+  }
+
+  const char* SubsetIndex::subsetName( uint64_t subset ) const
+  {
+    return _array< char >( _header->namesOffset ) +
+        _array< uint64_t >( _header->nameOffsetsOffset )[ subset ];
+  }
+
+  uint64_t SubsetIndex::subsetSize( uint64_t subset ) const
+  {
+    const uint64_t* offsets = _array< uint64_t >( _header->subsetOffsetsOffset );
+    return offsets[ subset + 1 ] - offsets[ subset ];
+  }
+
+  SubsetIndex::TGIDRange SubsetIndex::subsetGids( uint64_t subset ) const
+  {
+    const uint64_t* offsets = _array< uint64_t >( _header->subsetOffsetsOffset );
+    const uint32_t* gids = _array< uint32_t >( _header->gidsOffset );
+
+    return std::make_pair( gids + offsets[ subset ],
+                           gids + offsets[ subset + 1 ]);
+  }
+
+  uint64_t SubsetIndex::findSubset( const std::string& name ) const
+  {
+    uint64_t subsets = subsetsNumber( );
+    for( uint64_t i = 0; i < subsets; ++i )
+      if( name == subsetName( i ))
+        return i;
+
+    return subsets;
+  }
+
+  uint64_t SubsetIndex::eventsNumber( void ) const
+  {
+    return _header ? _header->eventsNumber : 0;
+  }
+
+  const char* SubsetIndex::eventName( uint64_t event ) const
+  {
+    return _array< char >( _header->namesOffset ) +
+        _array< uint64_t >( _header->nameOffsetsOffset )
+        [ _header->subsetsNumber + event ];
+  }
+
+  SubsetIndex::TFrameRange SubsetIndex::eventFrames( uint64_t event ) const
+  {
+    const uint64_t* offsets = _array< uint64_t >( _header->eventOffsetsOffset );
+    const float* frames = _array< float >( _header->framesOffset );
+
+    return std::make_pair( frames + offsets[ event ] * 2,
+                           frames + offsets[ event + 1 ] * 2 );
+  }
+
+  void SubsetIndex::exportEvents( simil::SubsetEventManager* manager ) const
+  {
+    if( !manager )
+      return;
+
+    for( uint64_t i = 0; i < eventsNumber( ); ++i )
+    {
+      auto frames = eventFrames( i );
+
+      EventVec event;
+      event.reserve(( frames.second - frames.first ) / 2 );
+      for( auto frame = frames.first; frame < frames.second; frame += 2 )
+        event.emplace_back( frame[ 0 ], frame[ 1 ]);
+
+      manager->addEvent( eventName( i ), event );
+    }
+  }
+
+  std::shared_ptr< SubsetIndex > SubsetIndex::load( const std::string& jsonFile )
+  {
+    std::shared_ptr< SubsetIndex > index =
+        std::make_shared< SubsetIndex >( jsonFile );
+
+    if( index->open( ))
+    {
+      std::cout << "Loading subsets from index " << index->filePath( )
+                << std::endl;
+      return index;
+    }
+
+    if( index->build( ))
+      return index;
+
+    return nullptr;
+  }
+
+}
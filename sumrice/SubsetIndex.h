@@ -0,0 +1,120 @@
+/*
+ * @file  SubsetIndex.h
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+#ifndef __VISIMPL_SUBSETINDEX__
+#define __VISIMPL_SUBSETINDEX__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QFile>
+
+#include <simil/simil.h>
+
+#include "types.h"
+
+namespace visimpl
+{
+
+  /*
+   * Compiled binary form of a subset/event JSON file: subset names, sorted
+   * gid arrays with their offsets and event time frames. The JSON source is
+   * read in a single streaming pass without building a document tree, and
+   * later sessions just map the index from the shared cache directory.
+   * Subset contents are handed out as ranges over the mapped file.
+   */
+  class SubsetIndex
+  {
+  public:
+
+    static const uint32_t MAGIC = 0x49535356; // "VSSI"
+    static const uint32_t VERSION = 1;
+
+    struct Header
+    {
+      uint32_t magic;
+      uint32_t version;
+
+      uint64_t sourceSize;
+      int64_t sourceMTime;
+      uint64_t sourceHash;
+
+      uint64_t subsetsNumber;
+      uint64_t eventsNumber;
+
+      // subsetsNumber + eventsNumber + 1 offsets into the names blob.
+      uint64_t nameOffsetsOffset;
+      uint64_t namesOffset;
+
+      // subsetsNumber + 1 offsets into the gids array.
+      uint64_t subsetOffsetsOffset;
+      uint64_t gidsOffset;
+
+      // eventsNumber + 1 offsets into the frames array, in frames.
+      uint64_t eventOffsetsOffset;
+      uint64_t framesOffset;
+    };
+
+    typedef std::pair< const uint32_t*, const uint32_t* > TGIDRange;
+    typedef std::pair< const float*, const float* > TFrameRange;
+
+    SubsetIndex( const std::string& sourceFile );
+    ~SubsetIndex( void );
+
+    // Maps the index file if present and still matching its source.
+    bool open( void );
+    void close( void );
+
+    // Parses the JSON source and writes the index file.
+    bool build( void );
+
+    bool valid( void ) const;
+    const std::string& filePath( void ) const;
+
+    uint64_t subsetsNumber( void ) const;
+    const char* subsetName( uint64_t subset ) const;
+    uint64_t subsetSize( uint64_t subset ) const;
+    TGIDRange subsetGids( uint64_t subset ) const;
+
+    // Position of the named subset, subsetsNumber( ) if not found.
+    uint64_t findSubset( const std::string& name ) const;
+
+    uint64_t eventsNumber( void ) const;
+    const char* eventName( uint64_t event ) const;
+    // Interleaved [ start, end ] pairs.
+    TFrameRange eventFrames( uint64_t event ) const;
+
+    // Event time frames are small, they are copied into the SimIL manager
+    // so event activity and labels keep working unchanged.
+    void exportEvents( simil::SubsetEventManager* manager ) const;
+
+    // Returns the index of the JSON file, building it first if needed.
+    static std::shared_ptr< SubsetIndex > load( const std::string& jsonFile );
+
+  protected:
+
+    template< typename T >
+    const T* _array( uint64_t offset ) const
+    {
+      return reinterpret_cast< const T* >( _data + offset );
+    }
+
+    std::string _sourceFile;
+    std::string _filePath;
+
+    QFile _file;
+    const uchar* _data;
+    const Header* _header;
+  };
+
+  typedef std::shared_ptr< const SubsetIndex > TSubsetIndexPtr;
+
+}
+
+#endif /* __VISIMPL_SUBSETINDEX__ */
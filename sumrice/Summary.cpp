@@ -8,6 +8,7 @@
  */
 
 #include "Summary.h"
+#include "PhaseTracer.h"
 
 #include <QMouseEvent>
 #include <QComboBox>
@@ -63,6 +64,7 @@ namespace visimpl
   , _simData( nullptr )
   , _spikeReport( nullptr )
   , _player( nullptr )
+  , _spikeStore( nullptr )
   , _mainHistogram( nullptr )
   , _detailHistogram( nullptr )
   , _focusedHistogram( nullptr )
@@ -192,8 +194,11 @@ namespace visimpl
 
   }
 
-  void Summary::Init( simil::SimulationData* data_ )
+  void Summary::Init( simil::SimulationData* data_,
+                      TGIDDictionaryPtr gidDictionary_,
+                      TSpikeTimeIndexPtr spikeIndex_ )
   {
+    ScopedPhase phase( "Summary::Init" );
 
     _simData = data_;
 
@@ -214,6 +219,19 @@ namespace visimpl
 
     _gids = GIDUSet( data_->gids( ).begin( ), data_->gids( ).end( ));
 
+    _gidDictionary = gidDictionary_ ? gidDictionary_ :
+        std::make_shared< const GIDDictionary >( data_->gids( ));
+
+    _spikeIndex = spikeIndex_;
+    if( !_spikeIndex && _spikeReport )
+    {
+      ScopedPhase indexPhase( "SpikeTimeIndex build" );
+
+      _spikeIndex = std::make_shared< SpikeTimeIndex >(
+          _spikeReport->spikes( ), _spikeReport->startTime( ),
+          _spikeReport->endTime( ));
+    }
+
     Init( );
   }
 
@@ -569,6 +587,9 @@ namespace visimpl
       return;
 
     _mainHistogram = new visimpl::HistogramWidget( *_spikeReport );
+    _mainHistogram->gidDictionary( _gidDictionary );
+    _mainHistogram->spikeIndex( _spikeIndex );
+    _mainHistogram->spikeStore( _spikeStore );
     _mainHistogram->setMinimumHeight( _heightPerRow );
     _mainHistogram->setMaximumHeight( _heightPerRow );
     _mainHistogram->colorScaleLocal( _colorScaleLocal );
@@ -756,6 +777,15 @@ namespace visimpl
       insertSubset( it->first, subset );
     }
 
+    if( !_subsetIndex )
+      return;
+
+    for( uint64_t i = 0; i < _subsetIndex->subsetsNumber( ); ++i )
+    {
+      auto range = _subsetIndex->subsetGids( i );
+      GIDUSet subset( range.first, range.second );
+      insertSubset( _subsetIndex->subsetName( i ), subset );
+    }
   }
 
   void Summary::AddNewHistogram( const visimpl::Selection& selection
@@ -847,6 +877,9 @@ namespace visimpl
 
     visimpl::HistogramWidget* histogram =
         new visimpl::HistogramWidget( *_spikeReport );
+    histogram->gidDictionary( _gidDictionary );
+    histogram->spikeIndex( _spikeIndex );
+    histogram->spikeStore( _spikeStore );
 
     histogram->filteredGIDs( subset );
     histogram->name( name );
@@ -1212,6 +1245,20 @@ namespace visimpl
   }
 
 
+  void Summary::UpdateSpikes( void )
+  {
+    if( !_spikeReport )
+      return;
+
+    if( _spikeIndex )
+      _spikeIndex->update( );
+
+    for( auto histogram : _histogramWidgets )
+      histogram->Spikes( *_spikeReport );
+
+    bins( _bins );
+  }
+
   void Summary::UpdateGradientColors( bool replace )
   {
     for( auto histogram : _histogramWidgets )
@@ -1572,6 +1619,52 @@ namespace visimpl
     return _gids;
   }
 
+  void Summary::gidDictionary( TGIDDictionaryPtr dictionary )
+  {
+    if( !dictionary )
+      return;
+
+    _gidDictionary = dictionary;
+    _gids = GIDUSet( _gidDictionary->gids( ).begin( ),
+                     _gidDictionary->gids( ).end( ));
+
+    for( auto histogram : _histogramWidgets )
+      histogram->gidDictionary( _gidDictionary );
+  }
+
+  TGIDDictionaryPtr Summary::gidDictionary( void ) const
+  {
+    return _gidDictionary;
+  }
+
+  TSpikeTimeIndexPtr Summary::spikeIndex( void ) const
+  {
+    return _spikeIndex;
+  }
+
+  void Summary::subsetIndex( TSubsetIndexPtr index )
+  {
+    _subsetIndex = index;
+  }
+
+  TSubsetIndexPtr Summary::subsetIndex( void ) const
+  {
+    return _subsetIndex;
+  }
+
+  void Summary::spikeStore( SpikePageStore* store )
+  {
+    _spikeStore = store;
+
+    for( auto histogram : _histogramWidgets )
+      histogram->spikeStore( _spikeStore );
+  }
+
+  SpikePageStore* Summary::spikeStore( void ) const
+  {
+    return _spikeStore;
+  }
+
   void Summary::gridLinesNumber( int linesNumber )
   {
     _gridLinesNumber = linesNumber;
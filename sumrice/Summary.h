@@ -29,6 +29,7 @@
 #include "EventWidget.h"
 #include "FocusFrame.h"
 #include "Histogram.h"
+#include "SubsetIndex.h"
 
 namespace visimpl
 {
@@ -68,7 +69,10 @@ namespace visimpl
     Summary( QWidget* parent = 0, TStackType stackType = T_STACK_FIXED);
     virtual ~Summary( ){};
 
-    void Init( simil::SimulationData* data_ );
+    void Init( simil::SimulationData* data_,
+               TGIDDictionaryPtr gidDictionary = nullptr,
+               TSpikeTimeIndexPtr spikeIndex = nullptr );
+    void UpdateSpikes( void );
 
     void AddNewHistogram( const visimpl::Selection& selection
   #ifdef VISIMPL_USE_ZEROEQ
@@ -101,6 +105,17 @@ namespace visimpl
     float regionWidth( void );
 
     const GIDUSet& gids( void );
+    // Replaces the gids of a grown network, histogram filters included.
+    void gidDictionary( TGIDDictionaryPtr dictionary );
+    TGIDDictionaryPtr gidDictionary( void ) const;
+
+    TSpikeTimeIndexPtr spikeIndex( void ) const;
+
+    void subsetIndex( TSubsetIndexPtr index );
+    TSubsetIndexPtr subsetIndex( void ) const;
+
+    void spikeStore( SpikePageStore* store );
+    SpikePageStore* spikeStore( void ) const;
 
     unsigned int gridLinesNumber( void );
 
@@ -270,6 +285,10 @@ namespace visimpl
     simil::SimulationPlayer* _player;
 
     GIDUSet _gids;
+    TGIDDictionaryPtr _gidDictionary;
+    TSubsetIndexPtr _subsetIndex;
+    TSpikeTimeIndexPtr _spikeIndex;
+    SpikePageStore* _spikeStore;
 
     visimpl::HistogramWidget* _mainHistogram;
     visimpl::HistogramWidget* _detailHistogram;
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ActivityKeyframes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace visimpl
+{
+  static const float NO_SPIKE = -std::numeric_limits< float >::max( );
+
+  ActivityKeyframes::ActivityKeyframes( TSpikeTimeIndexPtr spikeIndex,
+                                        TGIDDictionaryPtr gidDictionary,
+                                        float startTime, float endTime,
+                                        size_t memoryBudget_ )
+  : _spikeIndex( spikeIndex )
+  , _gidDictionary( gidDictionary )
+  , _startTime( startTime )
+  , _endTime( endTime )
+  , _memoryBudget( memoryBudget_ )
+  , _interval( 0.0f )
+  {
+    _configure( );
+  }
+
+  void ActivityKeyframes::memoryBudget( size_t bytes )
+  {
+    _memoryBudget = bytes;
+    _configure( );
+  }
+
+  size_t ActivityKeyframes::memoryBudget( void ) const
+  {
+    return _memoryBudget;
+  }
+
+  size_t ActivityKeyframes::residentBytes( void ) const
+  {
+    size_t result = 0;
+    for( const auto& keyframe : _keyframes )
+      result += keyframe.capacity( ) * sizeof( float );
+
+    return result;
+  }
+
+  float ActivityKeyframes::interval( void ) const
+  {
+    return _interval;
+  }
+
+  void ActivityKeyframes::clear( void )
+  {
+    for( auto& keyframe : _keyframes )
+      std::vector< float >( ).swap( keyframe );
+  }
+
+  void ActivityKeyframes::_configure( void )
+  {
+    _keyframes.clear( );
+
+    size_t keyframeBytes =
+        std::max( size_t( 1 ), _gidDictionary->size( )) * sizeof( float );
+    uint64_t keyframesNumber = _memoryBudget / keyframeBytes;
+
+    if( keyframesNumber == 0 )
+    {
+      _interval = 0.0f;
+      return;
+    }
+
+    _interval = std::max( _endTime - _startTime, 1.0f ) / keyframesNumber;
+    _keyframes.resize( keyframesNumber );
+
+    std::cout << "Activity keyframes every " << _interval << " ( "
+              << keyframesNumber << " x " << keyframeBytes / 1024
+              << " KB )" << std::endl;
+  }
+
+  float ActivityKeyframes::_keyframeTime( uint64_t keyframe ) const
+  {
+    return _startTime + keyframe * _interval;
+  }
+
+  void ActivityKeyframes::_apply( std::vector< float >& state, uint64_t first,
+                                  uint64_t last ) const
+  {
+    const auto& spikes = _spikeIndex->spikes( );
+    for( uint64_t i = first; i < last; ++i )
+    {
+      unsigned int idx = _gidDictionary->index( spikes[ i ].second );
+      if( idx != GIDDictionary::INVALID )
+        state[ idx ] = spikes[ i ].first;
+    }
+  }
+
+  const std::vector< float >& ActivityKeyframes::_keyframe( uint64_t keyframe )
+  {
+    if( !_keyframes[ keyframe ].empty( ))
+      return _keyframes[ keyframe ];
+
+    // Start from the closest computed keyframe and keep every keyframe
+    // passed on the way.
+    uint64_t current = keyframe;
+    while( current > 0 && _keyframes[ current ].empty( ))
+      --current;
+
+    std::vector< float > state = _keyframes[ current ].empty( ) ?
+        std::vector< float >( _gidDictionary->size( ), NO_SPIKE ) :
+        _keyframes[ current ];
+
+    uint64_t offset = _keyframes[ current ].empty( ) ?
+        0 : _spikeIndex->lowerBound( _keyframeTime( current ));
+
+    for( ++current; current <= keyframe; ++current )
+    {
+      uint64_t next = _spikeIndex->lowerBound( _keyframeTime( current ));
+      _apply( state, offset, next );
+      offset = next;
+
+      _keyframes[ current ] = state;
+    }
+
+    return _keyframes[ keyframe ];
+  }
+
+  uint64_t ActivityKeyframes::_lastAvailable( float time ) const
+  {
+    if( time <= _startTime )
+      return 0;
+
+    uint64_t keyframe = std::min( uint64_t( _keyframes.size( ) - 1 ),
+        uint64_t( std::floor(( time - _startTime ) / _interval )));
+
+    // Keyframes ahead of the loaded spikes would miss streamed ones.
+    uint64_t indexed = _spikeIndex->indexedSpikes( );
+    const auto& spikes = _spikeIndex->spikes( );
+    while( keyframe > 0 && ( indexed == 0 ||
+           spikes[ indexed - 1 ].first < _keyframeTime( keyframe )))
+      --keyframe;
+
+    return keyframe;
+  }
+
+  void ActivityKeyframes::advance( float time )
+  {
+    if( _keyframes.empty( ))
+      return;
+
+    uint64_t keyframe = _lastAvailable( time );
+    if( keyframe == 0 || !_keyframes[ keyframe ].empty( ))
+      return;
+
+    if( keyframe == 1 || !_keyframes[ keyframe - 1 ].empty( ))
+      _keyframe( keyframe );
+  }
+
+  bool ActivityKeyframes::activity( float time, float window,
+                                    TLastSpikes& result )
+  {
+    result.clear( );
+
+    if( _keyframes.empty( ) || time <= _startTime )
+      return false;
+
+    uint64_t keyframe = _lastAvailable( time );
+    if( keyframe == 0 )
+      return false;
+
+    float windowStart = time - window;
+    uint64_t last = _spikeIndex->lowerBound( time );
+    uint64_t windowSpikes = last - _spikeIndex->lowerBound( windowStart );
+    uint64_t first = _spikeIndex->lowerBound( _keyframeTime( keyframe ));
+
+    // Restoring walks every neuron, computing a keyframe walks the spikes
+    // since the previous one.
+    uint64_t cost = ( last - first ) + _gidDictionary->size( );
+    if( _keyframes[ keyframe ].empty( ))
+      cost += first;
+
+    if( windowSpikes <= cost )
+      return false;
+
+    _state = _keyframe( keyframe );
+    _apply( _state, first, last );
+
+    const auto& gids = _gidDictionary->gids( );
+    for( unsigned int i = 0; i < _state.size( ); ++i )
+    {
+      if( _state[ i ] >= windowStart )
+        result.emplace_back( gids[ i ], _state[ i ]);
+    }
+
+    return true;
+  }
+
+}
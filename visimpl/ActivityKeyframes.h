@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_ACTIVITYKEYFRAMES__
+#define __VISIMPL_ACTIVITYKEYFRAMES__
+
+#include <vector>
+
+#include <sumrice/sumrice.h>
+
+#include "types.h"
+
+namespace visimpl
+{
+  typedef std::vector< std::pair< uint32_t, float >> TLastSpikes;
+
+  /*
+   * Per-neuron last spike time at regular time points. Keyframes are
+   * computed lazily the first time a seek needs them, every keyframe passed
+   * on the way is kept, so later seeks restore the nearest one and only
+   * replay the spikes after it. The interval between keyframes is chosen so
+   * that all of them fit in the memory budget.
+   */
+  class ActivityKeyframes
+  {
+  public:
+
+    ActivityKeyframes( TSpikeTimeIndexPtr spikeIndex,
+                       TGIDDictionaryPtr gidDictionary,
+                       float startTime, float endTime,
+                       size_t memoryBudget );
+
+    void memoryBudget( size_t bytes );
+    size_t memoryBudget( void ) const;
+
+    size_t residentBytes( void ) const;
+    float interval( void ) const;
+
+    // Last spike time of every neuron that fired in [ time - window, time ).
+    // Returns false when replaying the window directly is cheaper.
+    bool activity( float time, float window, TLastSpikes& result );
+
+    // Computes the keyframe at time during playback when the previous one
+    // is known, spreading the cost over the frames.
+    void advance( float time );
+
+    void clear( void );
+
+  protected:
+
+    void _configure( void );
+
+    const std::vector< float >& _keyframe( uint64_t keyframe );
+    void _apply( std::vector< float >& state, uint64_t first,
+                 uint64_t last ) const;
+
+    float _keyframeTime( uint64_t keyframe ) const;
+    uint64_t _lastAvailable( float time ) const;
+
+    TSpikeTimeIndexPtr _spikeIndex;
+    TGIDDictionaryPtr _gidDictionary;
+
+    float _startTime;
+    float _endTime;
+    size_t _memoryBudget;
+
+    float _interval;
+
+    // Empty until computed.
+    std::vector< std::vector< float >> _keyframes;
+    std::vector< float > _state;
+  };
+
+}
+
+#endif /* __VISIMPL_ACTIVITYKEYFRAMES__ */
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace visimpl
+{
+  namespace allocations
+  {
+#ifndef NDEBUG
+    static std::atomic< uint64_t > _count( 0 );
+    static thread_local std::atomic< uint64_t >* _tracked = nullptr;
+
+    void* _allocate( std::size_t size )
+    {
+      _count.fetch_add( 1, std::memory_order_relaxed );
+      if( _tracked )
+        _tracked->fetch_add( 1, std::memory_order_relaxed );
+
+      void* ptr = std::malloc( size ? size : 1 );
+      if( !ptr )
+        throw std::bad_alloc( );
+
+      return ptr;
+    }
+
+    bool enabled( void )
+    {
+      return true;
+    }
+
+    uint64_t count( void )
+    {
+      return _count.load( std::memory_order_relaxed );
+    }
+
+    void track( std::atomic< uint64_t >* counter )
+    {
+      _tracked = counter;
+    }
+#else
+    bool enabled( void )
+    {
+      return false;
+    }
+
+    uint64_t count( void )
+    {
+      return 0;
+    }
+
+    void track( std::atomic< uint64_t >* )
+    { }
+#endif
+  }
+}
+
+#ifndef NDEBUG
+
+void* operator new( std::size_t size )
+{
+  return visimpl::allocations::_allocate( size );
+}
+
+void* operator new[]( std::size_t size )
+{
+  return visimpl::allocations::_allocate( size );
+}
+
+void operator delete( void* ptr ) noexcept
+{
+  std::free( ptr );
+}
+
+void operator delete[]( void* ptr ) noexcept
+{
+  std::free( ptr );
+}
+
+void operator delete( void* ptr, std::size_t ) noexcept
+{
+  std::free( ptr );
+}
+
+void operator delete[]( void* ptr, std::size_t ) noexcept
+{
+  std::free( ptr );
+}
+
+#endif
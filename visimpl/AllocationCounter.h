@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_ALLOCATIONCOUNTER__
+#define __VISIMPL_ALLOCATIONCOUNTER__
+
+#include <atomic>
+#include <cstdint>
+
+namespace visimpl
+{
+  /*
+   * Debug builds replace the global allocation operators to count heap
+   * allocations of the whole process, simulation and update threads
+   * included, so hot paths can check they stay allocation free once warmed
+   * up. Release builds keep the default operators and
+   * always report zero.
+   */
+  namespace allocations
+  {
+    bool enabled( void );
+
+    // Allocations performed so far by every thread.
+    uint64_t count( void );
+
+    // Also counts the calling thread allocations into counter, until called
+    // again with nullptr, so a thread can report its own share.
+    void track( std::atomic< uint64_t >* counter );
+  }
+}
+
+#endif /* __VISIMPL_ALLOCATIONCOUNTER__ */
@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "DataLoader.h"
+
+#include <iostream>
+
+namespace visimpl
+{
+  // Spikes handed to the GUI thread per batch.
+  static const uint64_t SPIKES_PER_BATCH = 1 << 20;
+
+  DataLoader::DataLoader( const std::string& networkFile,
+                          simil::TDataType dataType,
+                          const std::string& report,
+                          size_t memoryBudget,
+                          QObject* parent )
+  : QThread( parent )
+  , _networkFile( networkFile )
+  , _dataType( dataType )
+  , _report( report )
+  , _memoryBudget( memoryBudget )
+  , _paged( false )
+  , _totalTime( 0.0f )
+  , _done( false )
+  , _data( nullptr )
+  { }
+
+  DataLoader::~DataLoader( void )
+  {
+    wait( );
+
+    if( _data )
+      delete _data;
+  }
+
+  simil::SpikeData* DataLoader::waitData( void )
+  {
+    std::unique_lock< std::mutex > lock( _mutex );
+    _delivered.wait( lock, [ this ]{ return _data || _done; });
+
+    simil::SpikeData* result = _data;
+    _data = nullptr;
+
+    return result;
+  }
+
+  bool DataLoader::takeSpikes( TSpikes& spikes, float& horizon )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    if( _batches.empty( ))
+      return false;
+
+    spikes = std::move( _batches.front( ).first );
+    horizon = _batches.front( ).second;
+    _batches.pop_front( );
+
+    return true;
+  }
+
+  float DataLoader::totalTime( void ) const
+  {
+    return _totalTime;
+  }
+
+  bool DataLoader::paged( void ) const
+  {
+    return _paged;
+  }
+
+  std::vector< std::string > DataLoader::sourceFiles( void ) const
+  {
+    return SpikeCache::sourceFiles( _networkFile, _dataType, _report );
+  }
+
+  simil::TDataType DataLoader::dataType( void ) const
+  {
+    return _dataType;
+  }
+
+  const std::string& DataLoader::report( void ) const
+  {
+    return _report;
+  }
+
+  void DataLoader::run( void )
+  {
+    try
+    {
+      _load( );
+    }
+    catch( const std::exception& e )
+    {
+      std::cerr << "Error loading " << _networkFile << ": " << e.what( )
+                << std::endl;
+      emit progress( tr( "Error loading dataset: " ) + e.what( ));
+    }
+    catch( ... )
+    {
+      std::cerr << "Unknown error loading " << _networkFile << std::endl;
+      emit progress( tr( "Error loading dataset" ));
+    }
+
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      _done = true;
+    }
+    _delivered.notify_all( );
+  }
+
+  void DataLoader::_load( void )
+  {
+    SpikeCache cache( sourceFiles( ), _dataType, _report );
+
+    if( cache.open( ))
+      _loadFromCache( cache );
+    else if( _dataType == simil::TCSV )
+      _loadCSV( cache );
+    else
+      _loadComplete( );
+  }
+
+  void DataLoader::_loadFromCache( SpikeCache& cache )
+  {
+    ScopedPhase phase( "Parse cache" );
+
+    emit progress( tr( "Loading network from cache..." ));
+
+    const uint64_t gidsNumber = cache.gidsNumber( );
+    const uint32_t* gids = cache.gids( );
+    const float* positions = cache.positions( );
+
+    TPosVect positionsVec;
+    positionsVec.reserve( gidsNumber );
+    for( uint64_t i = 0; i < gidsNumber; ++i )
+      positionsVec.emplace_back( positions[ i * 3 ],
+                                 positions[ i * 3 + 1 ],
+                                 positions[ i * 3 + 2 ]);
+
+    _totalTime = cache.endTime( );
+
+    const uint64_t spikesNumber = cache.spikesNumber( );
+
+    _paged = _exceedsBudget( spikesNumber );
+
+    simil::SpikeData* data = new simil::SpikeData( );
+    data->setGids( TGIDSet( gids, gids + gidsNumber ));
+    data->setPositions( positionsVec );
+    data->setStartTime( cache.startTime( ));
+    data->setEndTime( _paged ? _totalTime : cache.startTime( ));
+    cache.exportSubsetsEvents( data->subsetsEvents( ));
+
+    _deliverNetwork( data );
+
+    if( !_paged )
+      _deliverCachedSpikes( cache );
+
+    emit progress( _paged ?
+        tr( "Spikes exceed memory budget, using paged access" ) :
+        tr( "Dataset loaded" ));
+  }
+
+  void DataLoader::_deliverCachedSpikes( SpikeCache& cache )
+  {
+    const uint64_t spikesNumber = cache.spikesNumber( );
+    const float* times = cache.times( );
+    const uint32_t* spikeGids = cache.spikeGids( );
+
+    for( uint64_t first = 0; first < spikesNumber; first += SPIKES_PER_BATCH )
+    {
+      uint64_t last = std::min( first + SPIKES_PER_BATCH, spikesNumber );
+
+      TSpikes batch;
+      batch.reserve( last - first );
+      for( uint64_t i = first; i < last; ++i )
+        batch.emplace_back( times[ i ], spikeGids[ i ]);
+
+      float horizon = ( last == spikesNumber ) ? _totalTime : times[ last ];
+
+      _deliverSpikes( std::move( batch ), horizon );
+      _reportProgress( last, spikesNumber );
+    }
+  }
+
+  void DataLoader::_loadCSV( SpikeCache& cache )
+  {
+    CSVLoader loader;
+
+    emit progress( tr( "Loading network..." ));
+    if( !loader.loadNetwork( _networkFile ))
+    {
+      _loadComplete( );
+      return;
+    }
+
+    simil::SpikeData* data = new simil::SpikeData( );
+    data->setGids( loader.gids( ));
+    data->setPositions( loader.positions( ));
+    data->setStartTime( 0.0f );
+    data->setEndTime( 0.0f );
+
+    _deliverNetwork( data );
+
+    emit progress( tr( "Loading spikes..." ));
+    if( !loader.loadActivity( _report ))
+    {
+      std::cerr << "Could not load activity file " << _report << std::endl;
+      emit progress( tr( "Could not load activity file, network only" ));
+      return;
+    }
+
+    loader.reduceDataToGIDS( );
+
+    const uint64_t spikesNumber = loader.spikes( ).size( );
+    _totalTime = loader.endTime( );
+
+    // Spikes are stored first and streamed back from the mapped cache, so
+    // the parsed copy is released before any batch is built.
+    if( cache.write( loader.gids( ), loader.positions( ), loader.spikes( ),
+                     loader.startTime( ), loader.endTime( )) &&
+        cache.open( ))
+    {
+      loader.takeSpikes( );
+
+      _paged = _exceedsBudget( spikesNumber );
+      if( !_paged )
+        _deliverCachedSpikes( cache );
+    }
+    else
+    {
+      // Without a cache the parsed spikes are handed over as one batch.
+      _deliverSpikes( loader.takeSpikes( ), _totalTime );
+      _reportProgress( spikesNumber, spikesNumber );
+    }
+
+    emit progress( _paged ?
+        tr( "Spikes exceed memory budget, using paged access" ) :
+        tr( "Dataset loaded" ));
+  }
+
+  void DataLoader::_loadComplete( void )
+  {
+    emit progress( tr( "Loading dataset..." ));
+
+    simil::SpikeData* data =
+        SpikeCache::load( _networkFile, _dataType, _report );
+    if( !data )
+    {
+      emit progress( tr( "Could not load dataset" ));
+      return;
+    }
+
+    _totalTime = data->endTime( );
+
+    // The parsed dataset has already been cached, drop its spikes and page
+    // them back from there.
+    if( _exceedsBudget( data->spikes( ).size( )))
+    {
+      SpikeCache cache( sourceFiles( ), _dataType, _report );
+      if( cache.open( ))
+      {
+        _paged = true;
+        data->setSpikes( TSpikes( ));
+      }
+    }
+
+    _deliverNetwork( data );
+
+    emit progress( _paged ?
+        tr( "Spikes exceed memory budget, using paged access" ) :
+        tr( "Dataset loaded" ));
+  }
+
+  void DataLoader::_deliverNetwork( simil::SpikeData* data )
+  {
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      _data = data;
+    }
+    _delivered.notify_all( );
+
+    emit networkLoaded( );
+  }
+
+  void DataLoader::_deliverSpikes( TSpikes&& spikes, float horizon )
+  {
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      _batches.emplace_back( std::move( spikes ), horizon );
+    }
+
+    emit spikesLoaded( );
+  }
+
+  bool DataLoader::_exceedsBudget( uint64_t spikesNumber ) const
+  {
+    return _memoryBudget > 0 && spikesNumber * sizeof( Spike ) > _memoryBudget;
+  }
+
+  void DataLoader::_reportProgress( uint64_t loaded, uint64_t total )
+  {
+    int percentage = total > 0 ? int( loaded * 100 / total ) : 100;
+
+    emit progress( tr( "Loading spikes: " ) + QString::number( percentage ) +
+                   "% (" + QString::number( loaded ) + " / " +
+                   QString::number( total ) + ")" );
+  }
+
+}
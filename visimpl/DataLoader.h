@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_DATALOADER__
+#define __VISIMPL_DATALOADER__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include <QThread>
+
+#include <simil/simil.h>
+#include <sumrice/sumrice.h>
+
+#include "types.h"
+
+namespace visimpl
+{
+
+  /*
+   * Background dataset loader. The network (gids and positions) is delivered
+   * first, handed over by waitData( ) and signalled through networkLoaded( ),
+   * then spikes arrive in time-ordered
+   * batches through spikesLoaded( ). Batches are queued here and must be
+   * taken from the GUI thread, which owns the SpikeData once delivered.
+   * Formats that SimIL can only parse as a whole arrive as a single
+   * complete network. Loading errors are reported through progress( ) and
+   * never escape the thread.
+   */
+  class DataLoader : public QThread
+  {
+    Q_OBJECT
+
+  public:
+
+    DataLoader( const std::string& networkFile,
+                simil::TDataType dataType,
+                const std::string& report = "",
+                size_t memoryBudget = 0,
+                QObject* parent = nullptr );
+    ~DataLoader( void );
+
+    // Blocks until the network is delivered, null if loading failed first.
+    simil::SpikeData* waitData( void );
+    bool takeSpikes( TSpikes& spikes, float& horizon );
+
+    float totalTime( void ) const;
+
+    // True when the spikes exceed the memory budget and must be read
+    // through a SpikePageStore instead of being delivered. Only final once
+    // the loader has finished.
+    bool paged( void ) const;
+
+    std::vector< std::string > sourceFiles( void ) const;
+    simil::TDataType dataType( void ) const;
+    const std::string& report( void ) const;
+
+  signals:
+
+    void networkLoaded( void );
+    void spikesLoaded( void );
+    void progress( const QString& message );
+
+  protected:
+
+    void run( void );
+
+    void _load( void );
+    void _loadFromCache( SpikeCache& cache );
+    void _loadCSV( SpikeCache& cache );
+    void _loadComplete( void );
+
+    void _deliverCachedSpikes( SpikeCache& cache );
+
+    void _deliverNetwork( simil::SpikeData* data );
+    void _deliverSpikes( TSpikes&& spikes, float horizon );
+    void _reportProgress( uint64_t loaded, uint64_t total );
+
+    bool _exceedsBudget( uint64_t spikesNumber ) const;
+
+    std::string _networkFile;
+    simil::TDataType _dataType;
+    std::string _report;
+
+    size_t _memoryBudget;
+    std::atomic< bool > _paged;
+
+    std::atomic< float > _totalTime;
+
+    std::mutex _mutex;
+    std::condition_variable _delivered;
+    bool _done;
+    simil::SpikeData* _data;
+    std::deque< std::pair< TSpikes, float >> _batches;
+  };
+
+}
+
+#endif /* __VISIMPL_DATALOADER__ */
@@ -25,6 +25,8 @@
 #include "prefr/UpdaterStaticPosition.h"
 #include "prefr/SourceMultiPosition.h"
 
+#include <algorithm>
+
 namespace visimpl
 {
   void expandBoundingBox( glm::vec3& minBounds,
@@ -40,6 +42,10 @@ namespace visimpl
 
   static float invRGBInt = 1.0f / 255;
 
+  // Particles per update task, sized so the decay columns of a chunk stay
+  // in cache.
+  static const size_t updateChunkSize = 2048;
+
   static std::unordered_map< std::string, std::string > _attributeNameLabels =
   {
     {"PYR", "Pyramidal"}, {"INT", "Interneuron"},
@@ -48,14 +54,19 @@ namespace visimpl
 
 
   DomainManager::DomainManager( prefr::ParticleSystem* particleSystem,
-                                      const TGIDSet& gids)
+                                TNetworkSnapshotPtr network )
   : _particleSystem( particleSystem )
-  , _gids( gids )
+  , _network( network )
   , _clusterSelected( nullptr )
   , _clusterUnselected( nullptr )
   , _clusterHighlighted( nullptr )
   , _sourceSelected( nullptr )
 //  , _sourceUnselected( nullptr )
+  , _lookupDirty( true )
+  , _positionsDirty( true )
+  , _fullUpdate( true )
+  , _emitting( false )
+  , _frameGeneration( 0 )
   , _currentAttrib( T_TYPE_UNDEFINED )
   , _modelBase( nullptr )
   , _modelOff( nullptr )
@@ -64,6 +75,7 @@ namespace visimpl
   , _updater( nullptr )
   , _mode( TMODE_SELECTION )
   , _decayValue( 0.0f )
+  , _lutSize( prefr::ColorOperationModel::DEFAULT_LUT_SIZE )
   , _showInactive( true )
   , _groupByName( false )
   , _autoGroupByName( true )
@@ -87,13 +99,15 @@ namespace visimpl
 
   }
 
-  void DomainManager::init( const tGidPosMap& positions
+  void DomainManager::init(
 #ifdef SIMIL_USE_BRION
-                            , const brion::BlueConfig* blueConfig
+                            const brion::BlueConfig* blueConfig
+#else
+                            void
 #endif
   )
   {
-    _gidPositions = positions;
+    ScopedPhase phase( "DomainManager::init" );
 
 #ifdef SIMIL_USE_BRION
     if( blueConfig )
@@ -104,8 +118,8 @@ namespace visimpl
     _sourceSelected = new SourceMultiPosition( );
 //    _sourceUnselected = new SourceMultiPosition( );
 
-    _sourceSelected->setPositions( _gidPositions );
-//    _sourceUnselected->setPositions( _gidPositions );
+    _sourceSelected->setPositions( &_particlePositions );
+//    _sourceUnselected->setPositions( _network );
 
 //    _particleSystem->addSource( _sourceSelected );
 //    _particleSystem->addSource( _sourceUnselected );
@@ -121,18 +135,25 @@ namespace visimpl
     _loadPaletteColors( );
   }
 
-  void DomainManager::initializeParticleSystem( void )
+  void DomainManager::initializeParticleSystem( bool render )
   {
+    ScopedPhase phase( "DomainManager::initializeParticleSystem" );
+
     std::cout << "Initializing particle system..." << std::endl;
 
     _updater = new UpdaterStaticPosition( );
-
-    prefr::Sorter* sorter = new prefr::Sorter( );
-    prefr::GLRenderer* renderer = new prefr::GLPickRenderer( );
+    _updater->batched( true );
 
     _particleSystem->addUpdater( _updater );
-    _particleSystem->sorter( sorter );
-    _particleSystem->renderer( renderer );
+
+    if( render )
+    {
+      prefr::Sorter* sorter = new prefr::Sorter( );
+      prefr::GLRenderer* renderer = new prefr::GLPickRenderer( );
+
+      _particleSystem->sorter( sorter );
+      _particleSystem->renderer( renderer );
+    }
 
     _modelOff = new prefr::ColorOperationModel( _decayValue, _decayValue );
     _modelOff->color.Insert( 0.0f, ( glm::vec4(0.1f, 0.1f, 0.1f, 0.2f)));
@@ -140,6 +161,7 @@ namespace visimpl
     _modelOff->velocity.Insert( 0.0f, 0.0f );
 
     _modelOff->size.Insert( 1.0f, 10.0f );
+    _modelOff->bake( _lutSize );
 
     _particleSystem->addModel( _modelOff );
 
@@ -150,6 +172,7 @@ namespace visimpl
     _modelHighlighted->velocity.Insert( 0.0f, 0.0f );
     _modelHighlighted->size.Insert( 0.0f, 20.0f );
     _modelHighlighted->size.Insert( 1.0f, 10.0f );
+    _modelHighlighted->bake( _lutSize );
     _particleSystem->addModel( _modelHighlighted );
 
 
@@ -163,6 +186,8 @@ namespace visimpl
 
     _modelBase->size.Insert( 0.0f, 20.0f );
     _modelBase->size.Insert( 1.0f, 10.0f );
+    _modelBase->bake( _lutSize );
+    _reportLUTError( );
 
     _particleSystem->addModel( _modelBase );
 
@@ -176,7 +201,12 @@ namespace visimpl
 
   const tGidPosMap& DomainManager::positions( void ) const
   {
-    return _gidPositions;
+    return _network->positions( );
+  }
+
+  TNetworkSnapshotPtr DomainManager::network( void ) const
+  {
+    return _network;
   }
 
   /*void DomainManager::positions( const tGidPosMap& positions_ )
@@ -190,23 +220,26 @@ namespace visimpl
   {
     _resetBoundingBox( );
 
+    if( _positionsDirty )
+      _updatePositions( );
+
     for( auto gidPartId : _gidToParticle )
     {
-      auto pos = _gidPositions.find( gidPartId.first );
+      const vec3& position = _particlePositions[ gidPartId.second ];
 
       auto particle = _particleSystem->particles( ).at( gidPartId.second );
-      particle.set_position( pos->second );
+      particle.set_position( position );
 
       expandBoundingBox( _boundingBox.first,
                          _boundingBox.second,
-                         pos->second );
+                         position );
     }
 
   }
 
   const TGIDSet& DomainManager::gids( void ) const
   {
-    return _gids;
+    return _network->gids( );
   }
 
   void DomainManager::mode( tVisualMode newMode )
@@ -274,6 +307,9 @@ namespace visimpl
 
   void DomainManager::_clearParticlesReference( void )
   {
+    _lookupDirty = true;
+    _fullUpdate = true;
+    _positionsDirty = true;
     _gidToParticle.clear( );
     _particleToGID.clear( );
 
@@ -417,13 +453,249 @@ namespace visimpl
 
   }
 
-  void DomainManager::updateData(const TGIDSet& gids,
-                                 const tGidPosMap& positions)
+  void DomainManager::updateParticles( float deltaTime )
+  {
+    if( _positionsDirty )
+      _updatePositions( );
+
+    if( !_updater || !_particleSystem->run( ))
+    {
+      _particleSystem->update( deltaTime );
+      return;
+    }
+
+    if( _fullUpdate || _emitting || _modelsChanged( ))
+      _updateAllParticles( deltaTime );
+    else
+      _updateActiveParticles( deltaTime );
+  }
+
+  void DomainManager::_activate( uint32_t particle )
+  {
+    // A pending full update rebuilds the whole set with fresh owners.
+    if( _fullUpdate || particle >= _particleCluster.size( ))
+      return;
+
+    prefr::Cluster* cluster = _particleCluster[ particle ];
+    if( !cluster )
+      return;
+
+    if( particle >= _activeSlot.size( ))
+      _activeSlot.resize( _particleCluster.size( ), 0 );
+
+    uint32_t& slot = _activeSlot[ particle ];
+    if( slot == 0 )
+    {
+      _activeParticles.push_back( { particle, cluster });
+      slot = _activeParticles.size( );
+    }
+  }
+
+  void DomainManager::_buildChunks( void )
+  {
+    // Particles may be in several clusters, the highlighted one or stale
+    // selection clusters. Each one is only updated by the last cluster
+    // holding it, the one whose model it is shown with, so chunks never
+    // share particles.
+    _particleCluster.assign( _particleSystem->particles( ).size( ), nullptr );
+
+    std::vector< prefr::Cluster* > clusters;
+    for( auto cluster : _particleSystem->clusters( ))
+    {
+      if( cluster->updater( ) != _updater )
+        continue;
+
+      clusters.push_back( cluster );
+      for( auto particle : cluster->particles( ).indices( ))
+        _particleCluster[ particle ] = cluster;
+    }
+
+    _clusterParticles.resize( clusters.size( ));
+
+    // Chunks keep their result buffers across frames.
+    size_t chunks = 0;
+
+    for( size_t i = 0; i < clusters.size( ); ++i )
+    {
+      prefr::Cluster* cluster = clusters[ i ];
+
+      std::vector< uint32_t >& owned = _clusterParticles[ i ];
+      owned.clear( );
+      for( auto particle : cluster->particles( ).indices( ))
+        if( _particleCluster[ particle ] == cluster )
+          owned.push_back( particle );
+
+      for( size_t begin = 0; begin < owned.size( ); begin += updateChunkSize )
+      {
+        if( chunks == _updateChunks.size( ))
+          _updateChunks.emplace_back( );
+
+        UpdateChunk& chunk = _updateChunks[ chunks++ ];
+        chunk.cluster = cluster;
+        chunk.particles = owned.data( ) + begin;
+        chunk.size = std::min( updateChunkSize, owned.size( ) - begin );
+      }
+    }
+
+    _updateChunks.resize( chunks );
+  }
+
+  void DomainManager::_updateAllParticles( float deltaTime )
   {
-      _gids = gids;
-      _gidPositions = positions;
+    if( _fullUpdate )
+      _buildChunks( );
+    _fullUpdate = false;
+
+    // Emission and any other updater still run inside prefr.
+    _particleSystem->update( deltaTime );
+
+    for( const auto& active : _activeParticles )
+      _activeSlot[ active.particle ] = 0;
+    _activeParticles.clear( );
+
+    auto& particles = _particleSystem->particles( );
+
+    _scheduler.run( _updateChunks.size( ),
+                    [ & ]( size_t i, unsigned int )
+    {
+      UpdateChunk& chunk = _updateChunks[ i ];
+      chunk.alive.clear( );
+      chunk.emit.clear( );
+
+      _updater->updateParticles( *chunk.cluster, particles, chunk.particles,
+                                 chunk.size, deltaTime, chunk.alive,
+                                 chunk.emit );
+    });
+
+    // Chunks are merged in order, so the result does not depend on the
+    // schedule.
+    size_t emitted = 0;
+
+    for( const auto& chunk : _updateChunks )
+    {
+      _updater->emitParticles( particles, chunk.emit );
+      emitted += chunk.emit.size( );
+
+      for( auto particle : chunk.alive )
+        _activate( particle );
+    }
+
+    _recordModels( );
+
+    // Sources emit on the prefr update following their restart, keep
+    // updating everything until they are done.
+    _emitting = emitted > 0;
+  }
+
+  void DomainManager::_updateActiveParticles( float deltaTime )
+  {
+    // Nothing is emitted nor changed since the last full update, so the
+    // prefr update is skipped and only lit particles decay. They are
+    // grouped by cluster and go through the same batched update as a full
+    // one, resolving each model once per chunk.
+    auto& particles = _particleSystem->particles( );
+
+    std::sort( _activeParticles.begin( ), _activeParticles.end( ),
+               []( const ActiveParticle& lhs, const ActiveParticle& rhs )
+               { return lhs.cluster < rhs.cluster; });
+
+    _activeIds.resize( _activeParticles.size( ));
+
+    size_t chunks = 0;
+    size_t begin = 0;
+
+    for( size_t i = 0; i < _activeParticles.size( ); ++i )
+    {
+      const ActiveParticle& active = _activeParticles[ i ];
+      _activeIds[ i ] = active.particle;
+      _activeSlot[ active.particle ] = 0;
+
+      bool last = ( i + 1 == _activeParticles.size( ) ||
+                    _activeParticles[ i + 1 ].cluster != active.cluster ||
+                    i + 1 - begin == updateChunkSize );
+      if( !last )
+        continue;
+
+      if( chunks == _activeChunks.size( ))
+        _activeChunks.emplace_back( );
+
+      UpdateChunk& chunk = _activeChunks[ chunks++ ];
+      chunk.cluster = active.cluster;
+      chunk.particles = _activeIds.data( ) + begin;
+      chunk.size = i + 1 - begin;
+
+      begin = i + 1;
+    }
+
+    _activeChunks.resize( chunks );
+    _activeParticles.clear( );
+
+    _scheduler.run( _activeChunks.size( ),
+                    [ & ]( size_t i, unsigned int )
+    {
+      UpdateChunk& chunk = _activeChunks[ i ];
+      chunk.alive.clear( );
+      chunk.emit.clear( );
+
+      _updater->updateParticles( *chunk.cluster, particles, chunk.particles,
+                                 chunk.size, deltaTime, chunk.alive,
+                                 chunk.emit );
+    });
+
+    // Decayed particles keep the render state of this last update.
+    for( const auto& chunk : _activeChunks )
+    {
+      _updater->emitParticles( particles, chunk.emit );
+
+      for( auto particle : chunk.alive )
+        _activate( particle );
+    }
+  }
+
+  bool DomainManager::_modelsChanged( void ) const
+  {
+    const auto& clusters = _particleSystem->clusters( );
+    if( clusters.size( ) != _clusterModels.size( ))
+      return true;
+
+    for( size_t i = 0; i < clusters.size( ); ++i )
+    {
+      const ClusterModel& reference = _clusterModels[ i ];
+      prefr::Model* model = clusters[ i ]->model( );
+      auto colorModel = dynamic_cast< prefr::ColorOperationModel* >( model );
+
+      if( reference.cluster != clusters[ i ] || reference.model != model )
+        return true;
+
+      // Color operation models report edits with or without tables, every
+      // model created here is one. Any other model only counts as changed
+      // when replaced.
+      if( colorModel && ( colorModel->modified( ) ||
+                          reference.version != colorModel->version( )))
+        return true;
+    }
+
+    return false;
+  }
+
+  void DomainManager::_recordModels( void )
+  {
+    _clusterModels.clear( );
+
+    for( auto cluster : _particleSystem->clusters( ))
+    {
+      prefr::Model* model = cluster->model( );
+      auto colorModel = dynamic_cast< prefr::ColorOperationModel* >( model );
+
+      _clusterModels.push_back(
+          { cluster, model, colorModel ? colorModel->version( ) : 0 });
+    }
+  }
+
+  void DomainManager::updateData( TNetworkSnapshotPtr network )
+  {
+      _setNetwork( network );
 
-      _sourceSelected->setPositions( _gidPositions );
       clearView();
       reloadPositions();
 
@@ -433,6 +705,100 @@ namespace visimpl
 
   }
 
+  void DomainManager::appendData( TNetworkSnapshotPtr network,
+                                  const TGIDSet& gids )
+  {
+    if( gids.empty( ))
+      return;
+
+    _setNetwork( network );
+
+    // Other modes only display the gids of their groups, new neurons are
+    // picked up the next time their indices are generated.
+    if( _mode != TMODE_SELECTION )
+      return;
+
+    auto availableParticles = _particleSystem->retrieveUnused( gids.size( ));
+    if( availableParticles.size( ) < gids.size( ))
+      std::cerr << "Not enough particles for " << gids.size( )
+                << " new neurons, " << availableParticles.size( )
+                << " available." << std::endl;
+
+    prefr::ParticleIndices indices;
+    prefr::ParticleIndices indicesSelected;
+    prefr::ParticleIndices indicesUnselected;
+
+    indices.reserve( availableParticles.size( ));
+
+    auto gidit = gids.begin( );
+    for( auto particle : availableParticles )
+    {
+      unsigned int id = particle.id( );
+
+      _gidToParticle.insert( std::make_pair( *gidit, id ));
+      _particleToGID.insert( std::make_pair( id, *gidit ));
+
+      _gidSource.insert( std::make_pair( *gidit, _sourceSelected ));
+
+      if( _selection.empty( ) || _selection.find( *gidit ) != _selection.end( ))
+      {
+        indicesSelected.emplace_back( id );
+
+        auto pos = _network->positions( ).find( *gidit )->second;
+        expandBoundingBox( _boundingBox.first, _boundingBox.second, pos );
+      }
+      else
+      {
+        indicesUnselected.emplace_back( id );
+      }
+
+      indices.emplace_back( id );
+
+      ++gidit;
+    }
+
+    _clusterSelected->particles( ).addIndices( indicesSelected );
+    _clusterUnselected->particles( ).addIndices( indicesUnselected );
+
+    // The updater looks source and model up in the particle system update
+    // config, register the new particles there as a full generation does.
+    _clusterSelected->setModel( _clusterSelected->model( ));
+    _clusterUnselected->setModel( _clusterUnselected->model( ));
+
+    prefr::ParticleIndices sourceIndices =
+        _sourceSelected->particles( ).indices( );
+    sourceIndices.insert( sourceIndices.end( ), indices.begin( ),
+                          indices.end( ));
+
+    _particleSystem->detachSource( _sourceSelected );
+    _particleSystem->addSource( _sourceSelected, sourceIndices );
+  }
+
+  void DomainManager::_setNetwork( TNetworkSnapshotPtr network )
+  {
+    _lookupDirty = true;
+    _fullUpdate = true;
+    _positionsDirty = true;
+    _network = network;
+  }
+
+  void DomainManager::_updatePositions( void )
+  {
+    // Particles are emitted at these positions, so the gid translation
+    // only happens here, when particle assignments change.
+    _particlePositions.resize( _particleSystem->particles( ).size( ));
+
+    const auto& positions = _network->positions( );
+    for( const auto& reference : _gidToParticle )
+    {
+      auto position = positions.find( reference.first );
+      if( position != positions.end( ))
+        _particlePositions[ reference.second ] = position->second;
+    }
+
+    _positionsDirty = false;
+  }
+
   void DomainManager::_resetBoundingBox( void )
   {
     _boundingBox.first = glm::vec3( std::numeric_limits< float >::max( ),
@@ -464,6 +830,7 @@ namespace visimpl
   void DomainManager::showInactive( bool state )
   {
     _showInactive = state;
+    _fullUpdate = true;
   }
 
   void DomainManager::setVisualGroupState( unsigned int i, bool state, bool attrib )
@@ -483,6 +850,7 @@ namespace visimpl
 
     group->active( state );
     group->cluster( )->setModel( state ? group->model( ) : _modelOff );
+    _fullUpdate = true;
 
     //TODO
     if( !_showInactive )
@@ -505,7 +873,7 @@ namespace visimpl
   {
     prefr::ParticleIndices selection;
     prefr::ParticleIndices other;
-    for( auto gid : _gids )
+    for( auto gid : _network->gids( ))
     {
       auto particleId = _gidToParticle.find( gid )->second;
 
@@ -531,7 +899,15 @@ namespace visimpl
 
   void DomainManager::_generateSelectionIndices( void )
   {
-    unsigned int numParticles = _gids.size( );
+    ScopedPhase phase( "DomainManager::_generateSelectionIndices" );
+    _lookupDirty = true;
+    _fullUpdate = true;
+    _positionsDirty = true;
+
+    const auto& gids = _network->gids( );
+    const auto& positions = _network->positions( );
+
+    unsigned int numParticles = gids.size( );
 
     prefr::ParticleIndices indices;
     prefr::ParticleIndices indicesSelected;
@@ -548,7 +924,7 @@ namespace visimpl
     _resetBoundingBox( );
 
 //    std::cout << "Particle ids: ";
-    auto gidit = _gids.begin( );
+    auto gidit = gids.begin( );
     for( auto particle : availableParticles )
     {
       unsigned int id = particle.id( );
@@ -566,7 +942,7 @@ namespace visimpl
         indicesSelected.emplace_back( id );
 //        _gidSource.insert( std::make_pair( *gidit, _sourceSelected ));
 
-        auto pos = _gidPositions.find( *gidit )->second;
+        auto pos = positions.find( *gidit )->second;
         expandBoundingBox( _boundingBox.first, _boundingBox.second, pos );
       }
       else
@@ -595,7 +971,6 @@ namespace visimpl
 //    _clusterSelected->setSource( _sourceSelected );
 //    _clusterUnselected->setSource( _sourceUnselected );
 //
-    _sourceSelected->setIdxTranslation( _particleToGID );
 //    _sourceUnselected->setIdxTranslation( _particleToGID );
 //
 //    _sourceSelected->restart( );
@@ -635,8 +1010,7 @@ namespace visimpl
     prefr::Cluster* cluster = new prefr::Cluster( );
 
     SourceMultiPosition* source = new SourceMultiPosition( );
-    source->setPositions( _gidPositions );
-    source->setIdxTranslation( _particleToGID );
+    source->setPositions( &_particlePositions );
 
     group->cluster( cluster );
     group->source( source );
@@ -696,6 +1070,9 @@ namespace visimpl
 
   void DomainManager::_clearGroup( VisualGroup* group, bool clearState )
   {
+    _lookupDirty = true;
+    _fullUpdate = true;
+    _positionsDirty = true;
 //    std::cout << "Clearing group " << group->name( )
 //              << " size " << group->gids( ).size( )
 //              << std::endl;
@@ -723,6 +1100,9 @@ namespace visimpl
 
   void DomainManager::_generateGroupsIndices( void )
   {
+    _lookupDirty = true;
+    _fullUpdate = true;
+    _positionsDirty = true;
     for( auto group : _groups )
     {
 
@@ -838,6 +1218,9 @@ namespace visimpl
 
   void DomainManager::_generateAttributesIndices( void )
   {
+    _lookupDirty = true;
+    _fullUpdate = true;
+    _positionsDirty = true;
     for( auto group : _attributeGroups )
     {
 
@@ -879,165 +1262,151 @@ namespace visimpl
   }
 
   void DomainManager::processInput( const simil::SpikesCRange& spikes_,
-                                       float begin, float end, bool clear )
+                                       float /*begin*/, float end, bool clear )
   {
     if( clear )
       resetParticles( );
 
-    switch( _mode )
-    {
-      case TMODE_SELECTION:
-        _processFrameInputSelection( spikes_, begin, end );
-        break;
-      case TMODE_GROUPS:
-        _processFrameInputGroups( spikes_, begin, end );
-        break;
-      case TMODE_ATTRIBUTE:
-        _processFrameInputAttributes( spikes_, begin, end );
-        break;
+    if( !_particleSystem || !_particleSystem->run( ))
+      return;
 
-      default:
-        break;
+    _beginFrame( );
+
+    // Spikes are sorted by time, newest first keeps the latest per neuron.
+    for( simil::SpikesCIter spike = spikes_.second; spike != spikes_.first; )
+    {
+      --spike;
+      _touch( spike->second, _decayValue - ( end - spike->first ));
     }
 
+    _applyFrame( );
   }
 
-  DomainManager::TModifiedNeurons
-  DomainManager::_parseInput( const simil::SpikesCRange& spikes_,
-                                float /*begin*/, float end )
+  void DomainManager::processActivity( const TLastSpikes& lastSpikes,
+                                       float end, bool clear )
   {
-    TModifiedNeurons result;
-    std::unordered_map< uint32_t, float > inserted;
+    if( clear )
+      resetParticles( );
 
-    for( simil::SpikesCIter spike = spikes_.first; spike != spikes_.second; ++spike )
-    {
-      float lifeValue = _decayValue - ( end - spike->first);
+    if( !_particleSystem || !_particleSystem->run( ))
+      return;
 
-      auto it = inserted.find( spike->second );
-      if( it == inserted.end( ))
-      {
-        inserted[ spike->second ] = lifeValue;
-//        *current = std::make_tuple( spike->second, lifeValue );
-      }
-    }
+    _beginFrame( );
 
-    result.reserve( inserted.size( ));
-    for( auto spike : inserted )
-    {
-      result.emplace_back( spike.first, spike.second );
-    }
+    for( const auto& neuron : lastSpikes )
+      _touch( neuron.first, _decayValue - ( end - neuron.second ));
 
-    return result;
+    _applyFrame( );
   }
 
-  void DomainManager::_processFrameInputSelection( const simil::SpikesCRange& spikes_,
-                                                     float begin, float end )
+  void DomainManager::_updateLookup( void )
   {
-    if( !_particleSystem || !_particleSystem->run( ) || _mode != TMODE_SELECTION )
-      return;
+    _gidDictionary = _network->gidDictionary( );
 
-    auto state = _parseInput( spikes_, begin, end );
+    const NeuronLookup empty = { GIDDictionary::INVALID, nullptr, false };
+    _neuronLookup.assign( _gidDictionary->size( ), empty );
 
-    for( const auto& neuron : state )
+    for( const auto& reference : _gidToParticle )
     {
-      auto gid = std::get< 0 >( neuron );
-
-      if( _selection.empty( ) || _selection.find( gid ) != _selection.end( ))
-      {
-        auto source = _gidSource.find( gid );
-        assert( source != _gidSource.end( ));
+      uint32_t idx = _gidDictionary->index( reference.first );
+      if( idx != GIDDictionary::INVALID )
+        _neuronLookup[ idx ].particle = reference.second;
+    }
 
-        if( source == _gidSource.end( ))
-        {
-          std::cout << "GID " << gid << " source not found." << std::endl;
-        }
+    for( const auto& neuronGroup : _neuronGroup )
+    {
+      uint32_t idx = _gidDictionary->index( neuronGroup.first );
+      if( idx != GIDDictionary::INVALID )
+        _neuronLookup[ idx ].group = neuronGroup.second;
+    }
 
-        unsigned int partIdx = _gidToParticle.find( gid )->second;
-        auto particle = _particleSystem->particles( ).at( partIdx );
-        particle.set_life( std::get< 1 >( neuron ));
+    if( _selection.empty( ))
+    {
+      for( auto& neuron : _neuronLookup )
+        neuron.selected = true;
+    }
+    else
+    {
+      for( auto gid : _selection )
+      {
+        uint32_t idx = _gidDictionary->index( gid );
+        if( idx != GIDDictionary::INVALID )
+          _neuronLookup[ idx ].selected = true;
       }
-
     }
-  }
 
+    _frameGeneration = 0;
+    _frameStamp.assign( _neuronLookup.size( ), 0 );
+    _frameLife.resize( _neuronLookup.size( ));
+    _frameTouched.clear( );
+    _frameTouched.reserve( _neuronLookup.size( ));
 
-  void DomainManager::_processFrameInputGroups( const simil::SpikesCRange& spikes_,
-                                                  float begin, float end )
-  {
+    _lookupDirty = false;
+  }
 
-    if( !_particleSystem || !_particleSystem->run( ) || _mode != TMODE_GROUPS )
-      return;
+  void DomainManager::_beginFrame( void )
+  {
+    if( _lookupDirty )
+      _updateLookup( );
 
-    auto state = _parseInput( spikes_, begin, end );
+    _frameTouched.clear( );
 
-    for( const auto& neuron : state )
+    // Stamps tell which neurons this frame already saw, without clearing.
+    if( ++_frameGeneration == 0 )
     {
-      auto gid = std::get< 0 >( neuron );
-
-      auto visualGroup = _neuronGroup.find( gid );
-
-//      assert( visualGroup != _neuronGroup.end( ));
-
-      if( visualGroup != _neuronGroup.end( ) && visualGroup->second->active( ))
-      {
-//        auto particles = _gidToParticle.equal_range( gid );
-//
-//        for( auto partIt = particles.first; partIt != particles.second; ++partIt )
-        auto partIt = _gidToParticle.find( gid );
-        if( partIt != _gidToParticle.end( ))
-        {
-          unsigned int particleIndex = partIt->second;
-
-          auto particle = _particleSystem->particles( ).at( particleIndex );
-          particle.set_life( std::get< 1 >( neuron ) );
-        }
-      }
+      std::fill( _frameStamp.begin( ), _frameStamp.end( ), 0 );
+      _frameGeneration = 1;
     }
-
   }
 
-
-  void DomainManager::_processFrameInputAttributes( const simil::SpikesCRange& spikes_,
-                                                  float begin, float end )
+  void DomainManager::_touch( uint32_t gid, float life )
   {
-
-    if( !_particleSystem || !_particleSystem->run( ) || _mode != TMODE_ATTRIBUTE )
+    uint32_t idx = _gidDictionary->index( gid );
+    if( idx == GIDDictionary::INVALID || _frameStamp[ idx ] == _frameGeneration )
       return;
 
-    auto state = _parseInput( spikes_, begin, end );
+    _frameStamp[ idx ] = _frameGeneration;
+    _frameLife[ idx ] = life;
+    _frameTouched.push_back( idx );
+  }
 
-    for( const auto& neuron : state )
-    {
-      auto gid = std::get< 0 >( neuron );
+  void DomainManager::_applyFrame( void )
+  {
+    auto& particles = _particleSystem->particles( );
 
-      auto visualGroup = _neuronGroup.find( gid );
-//      auto groups = _neuronGroup.equal_range( gid );
-//      assert( visualGroup != _neuronGroup.end( ));
+    for( auto idx : _frameTouched )
+    {
+      const NeuronLookup& neuron = _neuronLookup[ idx ];
+      if( neuron.particle == GIDDictionary::INVALID )
+        continue;
 
-      if( visualGroup != _neuronGroup.end( ) && visualGroup->second->active( ))
-//      for( auto groupIt = groups.first; groupIt != groups.second; ++groupIt )
+      switch( _mode )
       {
-//        auto particles = _gidToParticle.equal_range( gid );
-//        for( auto partIt = particles.first; partIt != particles.second; ++partIt )
-        auto partIt = _gidToParticle.find( gid );
-        if( partIt != _gidToParticle.end( ))
-        {
-          unsigned int particleIndex = partIt->second;
-//          auto group = groupIt->second;
-//          if( group && group->source( )->particles( ).hasElement( particleIndex ))
-//          {
-          auto particle = _particleSystem->particles( ).at( particleIndex );
-          particle.set_life( std::get< 1 >( neuron ) );
-//          }
-        }
+        case TMODE_SELECTION:
+          if( !neuron.selected )
+            continue;
+          break;
+        case TMODE_GROUPS:
+        case TMODE_ATTRIBUTE:
+          if( !neuron.group || !neuron.group->active( ))
+            continue;
+          break;
+        default:
+          continue;
       }
-    }
 
+      auto particle = particles.at( neuron.particle );
+      particle.set_life( _frameLife[ idx ]);
+
+      _activate( neuron.particle );
+    }
   }
 
 
   void DomainManager::selection( const GIDUSet& newSelection )
   {
+    _lookupDirty = true;
+    _fullUpdate = true;
     _selection = newSelection;
 
     if( _mode == TMODE_SELECTION )
@@ -1118,8 +1487,57 @@ namespace visimpl
     return _decayValue;
   }
 
+  void DomainManager::lutSize( unsigned int entries )
+  {
+    _lutSize = entries;
+
+    for( auto model : { _modelBase, _modelOff, _modelHighlighted })
+      if( model )
+        model->bake( entries );
+
+    for( auto groups : { &_groups, &_attributeGroups })
+      for( auto group : *groups )
+      {
+        auto model =
+            dynamic_cast< prefr::ColorOperationModel* >( group->model( ));
+        if( model )
+          model->bake( entries );
+      }
+
+    _reportLUTError( );
+  }
+
+  void DomainManager::_reportLUTError( void ) const
+  {
+    if( _modelBase && _lutSize > 0 )
+      std::cout << "Transfer function tables of " << _lutSize
+                << " entries, max color error " << _modelBase->colorError( )
+                << ", max size error " << _modelBase->sizeError( )
+                << std::endl;
+  }
+
+  unsigned int DomainManager::lutSize( void ) const
+  {
+    return _lutSize;
+  }
+
+  void DomainManager::updateThreads( unsigned int threads )
+  {
+    _scheduler.threads( threads );
+
+    std::cout << "Updating particles with " << _scheduler.threads( )
+              << " threads" << std::endl;
+  }
+
+  unsigned int DomainManager::updateThreads( void ) const
+  {
+    return _scheduler.threads( );
+  }
+
   void DomainManager::clearSelection( void )
   {
+    _lookupDirty = true;
+    _fullUpdate = true;
     _selection.clear( );
 
     if( _mode == TMODE_SELECTION )
@@ -1156,7 +1574,8 @@ namespace visimpl
 
     _particleSystem->run( true );
 
-    _particleSystem->update( 0.0f );
+    _fullUpdate = true;
+    updateParticles( 0.0f );
   }
 
   const std::vector< VisualGroup* >& DomainManager::groups( void ) const
@@ -1191,7 +1610,7 @@ namespace visimpl
   {
     tNeuronAttribs result;
 
-    const auto& gids = _gids;
+    const auto& gids = _network->gids( );
 
     try
     {
@@ -1544,10 +1963,13 @@ namespace visimpl
 
      _clusterHighlighted->setModel( _modelHighlighted );
 
+     _fullUpdate = true;
+
    }
 
    void DomainManager::clearHighlighting( void )
    {
+     _fullUpdate = true;
 
      if( _mode == TMODE_SELECTION )
      {
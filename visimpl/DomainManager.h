@@ -33,8 +33,12 @@
 
 #include "types.h"
 #include "VisualGroup.h"
+#include "NetworkSnapshot.h"
+#include "ActivityKeyframes.h"
+#include "UpdateScheduler.h"
 #include "prefr/ColorOperationModel.h"
 #include "prefr/SourceMultiPosition.h"
+#include "prefr/UpdaterStaticPosition.h"
 
 namespace visimpl
 {
@@ -51,19 +55,22 @@ namespace visimpl
   {
   public:
 
-    DomainManager( prefr::ParticleSystem* particleSystem, const TGIDSet& gids );
+    DomainManager( prefr::ParticleSystem* particleSystem,
+                   TNetworkSnapshotPtr network );
 
     ~DomainManager( );
 
 
 #ifdef SIMIL_USE_BRION
-    void init( const tGidPosMap& positions, const brion::BlueConfig* blueConfig );
+    void init( const brion::BlueConfig* blueConfig );
 #else
-    void init( const tGidPosMap& positions );
+    void init( void );
 #endif
 
 
-    void initializeParticleSystem( void );
+    // Without rendering no sorter nor GL renderer is created, so particles
+    // can be updated with no GL context.
+    void initializeParticleSystem( bool render = true );
 
     VisualGroup* addVisualGroupFromSelection( const std::string& name,
                                               bool overrideGIDs = false );
@@ -78,12 +85,25 @@ namespace visimpl
 
     void generateAttributesGroups( tNeuronAttributes attrib );
 
+    // The latest spike of every neuron sets its life, as in activity
+    // keyframes. Later ranges of a deferred frame override earlier ones.
     void processInput( const simil::SpikesCRange& spikes_,
                        float begin, float end, bool clear );
 
+    // Neuron last spike times, as restored from activity keyframes.
+    void processActivity( const TLastSpikes& lastSpikes, float end,
+                          bool clear );
+
     void update( void );
 
-    void updateData(const TGIDSet& gids,const tGidPosMap& positions);
+    // Updates the particle system. Clusters driven by the static position
+    // updater are processed in batch, split into chunks run on the update
+    // threads.
+    void updateParticles( float deltaTime );
+
+    void updateData( TNetworkSnapshotPtr network );
+    // Network must contain the current one plus the new gids.
+    void appendData( TNetworkSnapshotPtr network, const TGIDSet& newGids );
 
     void mode( tVisualMode newMode );
     tVisualMode mode( void );
@@ -100,6 +120,15 @@ namespace visimpl
     void decay( float decayValue );
     float decay( void ) const;
 
+    // Entries of the baked transfer function tables of every model, 0 to
+    // evaluate the exact curves.
+    void lutSize( unsigned int entries );
+    unsigned int lutSize( void ) const;
+
+    // Threads updating particle chunks, 0 for every hardware thread.
+    void updateThreads( unsigned int threads );
+    unsigned int updateThreads( void ) const;
+
     void clearSelection( void );
     void resetParticles( void );
 
@@ -109,6 +138,8 @@ namespace visimpl
     const tGidPosMap& positions( void ) const;
     //void positions( const tGidPosMap& );
 
+    TNetworkSnapshotPtr network( void ) const;
+
     void reloadPositions( void );
 
 
@@ -136,10 +167,57 @@ namespace visimpl
 
   protected:
 
-    typedef std::vector< std::tuple< uint32_t, float >> TModifiedNeurons;
-
-    TModifiedNeurons _parseInput( const simil::SpikesCRange& spikes_,
-                                 float begin, float end );
+    // Dense per-neuron view of the particle references, rebuilt only when
+    // they change so frames do not search any map.
+    struct NeuronLookup
+    {
+      uint32_t particle;
+      VisualGroup* group;
+      bool selected;
+    };
+
+    void _updateLookup( void );
+    void _reportLUTError( void ) const;
+    void _updatePositions( void );
+
+    // Particles with life left. Frames only update these, everything else
+    // keeps the render state of its last update. Any change of particle
+    // assignments, clusters or models triggers a full update instead,
+    // which rebuilds the set.
+    struct ActiveParticle
+    {
+      uint32_t particle;
+      prefr::Cluster* cluster;
+    };
+
+    // Particles owned by a cluster updated as a single scheduler task, with
+    // its own results so chunks never share output.
+    struct UpdateChunk
+    {
+      prefr::Cluster* cluster;
+      const uint32_t* particles;
+      size_t size;
+      std::vector< uint32_t > alive;
+      std::vector< uint32_t > emit;
+    };
+
+    struct ClusterModel
+    {
+      prefr::Cluster* cluster;
+      prefr::Model* model;
+      unsigned int version;
+    };
+
+    inline void _activate( uint32_t particle );
+    void _buildChunks( void );
+    void _updateAllParticles( float deltaTime );
+    void _updateActiveParticles( float deltaTime );
+    bool _modelsChanged( void ) const;
+    void _recordModels( void );
+
+    void _beginFrame( void );
+    inline void _touch( uint32_t gid, float life );
+    void _applyFrame( void );
 
 
     VisualGroup* _generateGroup( const GIDUSet& gids, const std::string& name,
@@ -154,12 +232,6 @@ namespace visimpl
     void _updateAttributesIndices( void );
     void _generateAttributesIndices( void );
 
-    void _processFrameInputSelection( const simil::SpikesCRange& spikes_,
-                                      float begin, float end );
-    void _processFrameInputGroups( const simil::SpikesCRange& spikes_,
-                                   float begin, float end );
-    void _processFrameInputAttributes( const simil::SpikesCRange& spikes_,
-                                       float begin, float end );
 
     void _loadPaletteColors( void );
 
@@ -175,6 +247,8 @@ namespace visimpl
 
     void _resetBoundingBox( void );
 
+    void _setNetwork( TNetworkSnapshotPtr network );
+
     SourceMultiPosition* _getSource( unsigned int numParticles );
 
 #ifdef SIMIL_USE_BRION
@@ -183,9 +257,7 @@ namespace visimpl
 
     prefr::ParticleSystem* _particleSystem;
 
-    tGidPosMap _gidPositions;
-
-    TGIDSet _gids;
+    TNetworkSnapshotPtr _network;
 
     prefr::Cluster* _clusterSelected;
     prefr::Cluster* _clusterUnselected;
@@ -204,18 +276,51 @@ namespace visimpl
     tUintUMap _gidToParticle;
     tUintUMap _particleToGID;
 
+    TGIDDictionaryPtr _gidDictionary;
+    std::vector< NeuronLookup > _neuronLookup;
+    bool _lookupDirty;
+
+    // Dense copy of the network positions indexed by particle id, read by
+    // every source when emitting.
+    TParticlePositions _particlePositions;
+    bool _positionsDirty;
+
+    std::vector< ActiveParticle > _activeParticles;
+    // Position in the active set plus one, 0 for inactive particles.
+    std::vector< uint32_t > _activeSlot;
+    // Single cluster updating each particle and the particles each
+    // cluster owns, rebuilt on full updates.
+    std::vector< prefr::Cluster* > _particleCluster;
+    std::vector< std::vector< uint32_t >> _clusterParticles;
+    std::vector< UpdateChunk > _updateChunks;
+    // Active particles sorted by cluster and their chunks, reused across
+    // frames.
+    std::vector< uint32_t > _activeIds;
+    std::vector< UpdateChunk > _activeChunks;
+    UpdateScheduler _scheduler;
+    std::vector< ClusterModel > _clusterModels;
+    bool _fullUpdate;
+    bool _emitting;
+
+    // Per-frame scratch, reused across frames.
+    uint32_t _frameGeneration;
+    std::vector< uint32_t > _frameStamp;
+    std::vector< float > _frameLife;
+    std::vector< uint32_t > _frameTouched;
+
     prefr::ColorOperationModel* _modelBase;
     prefr::ColorOperationModel* _modelOff;
     prefr::ColorOperationModel* _modelHighlighted;
 
     prefr::PointSampler* _sampler;
-    prefr::Updater* _updater;
+    UpdaterStaticPosition* _updater;
 
     tVisualMode _mode;
 
     GIDUSet _selection;
 
     float _decayValue;
+    unsigned int _lutSize;
 
     bool _showInactive;
 
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "EventTimeline.h"
+
+#include <algorithm>
+
+namespace visimpl
+{
+
+  EventTimeline::EventTimeline( void )
+  : _sorted( true )
+  , _cursor( 0 )
+  { }
+
+  void EventTimeline::clear( void )
+  {
+    _boundaries.clear( );
+    _sorted = true;
+    _cursor = 0;
+
+    _open.clear( );
+    _active.clear( );
+    _crossed.clear( );
+    _candidates.clear( );
+    _toggled.clear( );
+  }
+
+  unsigned int EventTimeline::addEvent( const EventVec& timeFrames )
+  {
+    unsigned int event = _open.size( );
+
+    for( const auto& timeFrame : timeFrames )
+    {
+      if( timeFrame.second <= timeFrame.first )
+        continue;
+
+      _boundaries.push_back({ timeFrame.first, event, true });
+      _boundaries.push_back({ timeFrame.second, event, false });
+    }
+
+    _open.push_back( 0 );
+    _active.push_back( false );
+    _crossed.push_back( false );
+
+    // Restart from the beginning, boundaries are sorted on the next seek.
+    std::fill( _open.begin( ), _open.end( ), 0 );
+    std::fill( _active.begin( ), _active.end( ), false );
+    _cursor = 0;
+    _sorted = false;
+
+    return event;
+  }
+
+  unsigned int EventTimeline::size( void ) const
+  {
+    return _open.size( );
+  }
+
+  bool EventTimeline::seek( float time )
+  {
+    if( !_sorted )
+    {
+      std::stable_sort( _boundaries.begin( ), _boundaries.end( ));
+      _sorted = true;
+    }
+
+    _candidates.clear( );
+    _toggled.clear( );
+
+    while( _cursor < _boundaries.size( ) && _boundaries[ _cursor ].time <= time )
+      _apply( _boundaries[ _cursor++ ], true );
+
+    while( _cursor > 0 && _boundaries[ _cursor - 1 ].time > time )
+      _apply( _boundaries[ --_cursor ], false );
+
+    for( auto event : _candidates )
+    {
+      _crossed[ event ] = false;
+
+      bool active = _open[ event ] > 0;
+      if( active != bool( _active[ event ]))
+      {
+        _active[ event ] = active;
+        _toggled.push_back( event );
+      }
+    }
+
+    return !_toggled.empty( );
+  }
+
+  bool EventTimeline::active( unsigned int event ) const
+  {
+    return _active[ event ];
+  }
+
+  const std::vector< unsigned int >& EventTimeline::toggled( void ) const
+  {
+    return _toggled;
+  }
+
+  void EventTimeline::_apply( const Boundary& boundary, bool forward )
+  {
+    if( boundary.start == forward )
+      ++_open[ boundary.event ];
+    else
+      --_open[ boundary.event ];
+
+    if( !_crossed[ boundary.event ])
+    {
+      _crossed[ boundary.event ] = true;
+      _candidates.push_back( boundary.event );
+    }
+  }
+
+}
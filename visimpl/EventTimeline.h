@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_EVENTTIMELINE__
+#define __VISIMPL_EVENTTIMELINE__
+
+#include <cstdint>
+#include <vector>
+
+#include <sumrice/sumrice.h>
+
+#include "types.h"
+
+namespace visimpl
+{
+  /*
+   * Exact event activation over time. Start and end times of every event
+   * time frame are kept sorted in a single list and a cursor moves over it
+   * as playback time changes, so each call only visits the boundaries
+   * crossed since the previous one. Time frames cover [ start, end ).
+   */
+  class EventTimeline
+  {
+  public:
+
+    EventTimeline( void );
+
+    void clear( void );
+
+    // Returns the position of the event.
+    unsigned int addEvent( const EventVec& timeFrames );
+
+    unsigned int size( void ) const;
+
+    // Moves the cursor to time, returns true if any event toggled.
+    bool seek( float time );
+
+    bool active( unsigned int event ) const;
+
+    // Events whose state changed in the last seek( ).
+    const std::vector< unsigned int >& toggled( void ) const;
+
+  protected:
+
+    struct Boundary
+    {
+      float time;
+      uint32_t event;
+      bool start;
+
+      bool operator<( const Boundary& other ) const
+      {
+        return time < other.time;
+      }
+    };
+
+    void _apply( const Boundary& boundary, bool forward );
+
+    std::vector< Boundary > _boundaries;
+    bool _sorted;
+
+    // Boundaries before the cursor have been applied.
+    size_t _cursor;
+
+    // Open time frames of every event, they may overlap.
+    std::vector< uint32_t > _open;
+    std::vector< uint8_t > _active;
+
+    std::vector< uint8_t > _crossed;
+    std::vector< unsigned int > _candidates;
+    std::vector< unsigned int > _toggled;
+  };
+
+}
+
+#endif /* __VISIMPL_EVENTTIMELINE__ */
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "FrameGovernor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace visimpl
+{
+  const unsigned int FrameGovernor::MAX_COALESCED_STEPS;
+  const uint64_t FrameGovernor::MIN_SPIKES_PER_FRAME;
+
+  // Exponential moving average weight of a new sample.
+  static const double SAMPLE_WEIGHT = 0.2;
+
+  // Samples with fewer spikes are dominated by fixed costs.
+  static const uint64_t MIN_SAMPLE_SPIKES = 256;
+
+  // Input always gets at least this fraction of the budget.
+  static const double MIN_INPUT_FRACTION = 0.25;
+
+  FrameGovernor::FrameGovernor( float budgetMilliseconds )
+  : _budget( budgetMilliseconds * 1000.0 )
+  , _spikeCost( 0.1 )
+  , _renderCost( 0.0 )
+  , _coalescedTime( 0.0 )
+  , _deferredFrames( 0 )
+  { }
+
+  void FrameGovernor::budget( float milliseconds )
+  {
+    _budget = std::max( 0.0f, milliseconds ) * 1000.0;
+  }
+
+  float FrameGovernor::budget( void ) const
+  {
+    return _budget * 0.001;
+  }
+
+  bool FrameGovernor::enabled( void ) const
+  {
+    return _budget > 0.0;
+  }
+
+  void FrameGovernor::inputCost( uint64_t spikes, double microseconds )
+  {
+    if( spikes < MIN_SAMPLE_SPIKES )
+      return;
+
+    _spikeCost += ( microseconds / spikes - _spikeCost ) * SAMPLE_WEIGHT;
+  }
+
+  void FrameGovernor::renderCost( double microseconds )
+  {
+    _renderCost += ( microseconds - _renderCost ) * SAMPLE_WEIGHT;
+  }
+
+  unsigned int FrameGovernor::steps( double elapsedMicroseconds,
+                                     double periodMicroseconds ) const
+  {
+    if( !enabled( ) || periodMicroseconds <= 0.0 )
+      return 1;
+
+    double steps = std::floor( elapsedMicroseconds / periodMicroseconds );
+
+    return std::max( 1u, std::min( MAX_COALESCED_STEPS,
+                                   ( unsigned int ) steps ));
+  }
+
+  uint64_t FrameGovernor::spikeBudget( void ) const
+  {
+    if( !enabled( ) || _spikeCost <= 0.0 )
+      return std::numeric_limits< uint64_t >::max( );
+
+    double available = std::max( _budget - _renderCost,
+                                 _budget * MIN_INPUT_FRACTION );
+
+    return std::max( MIN_SPIKES_PER_FRAME,
+                     ( uint64_t ) ( available / _spikeCost ));
+  }
+
+  void FrameGovernor::coalesced( double simulationTime )
+  {
+    _coalescedTime += simulationTime;
+  }
+
+  void FrameGovernor::deferred( void )
+  {
+    ++_deferredFrames;
+  }
+
+  double FrameGovernor::coalescedTime( void ) const
+  {
+    return _coalescedTime;
+  }
+
+  unsigned int FrameGovernor::deferredFrames( void ) const
+  {
+    return _deferredFrames;
+  }
+
+  void FrameGovernor::resetStatistics( void )
+  {
+    _coalescedTime = 0.0;
+    _deferredFrames = 0;
+  }
+
+}
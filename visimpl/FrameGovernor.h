@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_FRAMEGOVERNOR__
+#define __VISIMPL_FRAMEGOVERNOR__
+
+#include <cstdint>
+
+namespace visimpl
+{
+  /*
+   * Keeps playback frames under a time budget. Input and render stage costs
+   * are measured every frame; the spikes that fit in the budget left by
+   * rendering are estimated from the measured cost per spike. Larger frames
+   * are spread over several rendered frames with simulation time frozen,
+   * and when rendering falls behind the simulation period consecutive
+   * steps are coalesced into a single input pass.
+   */
+  class FrameGovernor
+  {
+  public:
+
+    static const unsigned int MAX_COALESCED_STEPS = 8;
+    static const uint64_t MIN_SPIKES_PER_FRAME = 1024;
+
+    // A budget of 0 disables the governor.
+    FrameGovernor( float budgetMilliseconds = 16.0f );
+
+    void budget( float milliseconds );
+    float budget( void ) const;
+    bool enabled( void ) const;
+
+    void inputCost( uint64_t spikes, double microseconds );
+    void renderCost( double microseconds );
+
+    // Simulation steps due after elapsed time, in [ 1, MAX_COALESCED_STEPS ].
+    unsigned int steps( double elapsedMicroseconds,
+                        double periodMicroseconds ) const;
+
+    // Spikes that can be processed in the current frame.
+    uint64_t spikeBudget( void ) const;
+
+    // Statistics since the last resetStatistics( ).
+    void coalesced( double simulationTime );
+    void deferred( void );
+
+    double coalescedTime( void ) const;
+    unsigned int deferredFrames( void ) const;
+    void resetStatistics( void );
+
+  protected:
+
+    double _budget;
+
+    double _spikeCost;
+    double _renderCost;
+
+    double _coalescedTime;
+    unsigned int _deferredFrames;
+  };
+
+}
+
+#endif /* __VISIMPL_FRAMEGOVERNOR__ */
@@ -101,6 +101,9 @@ namespace visimpl
   , _endTimeLabel( nullptr )
   , _repeatButton( nullptr )
   , _goToButton( nullptr )
+  , _abRepeatButton( nullptr )
+  , _abBegin( 0.0f )
+  , _abBeginSet( false )
   , _simConfigurationDock( nullptr )
   , _modeSelectionWidget( nullptr )
   , _toolBoxOptions( nullptr )
@@ -218,6 +221,15 @@ namespace visimpl
     connect( _openGLWidget, SIGNAL( pickedSingle( unsigned int )),
              this, SLOT( updateSelectedStatsPickingSingle( unsigned int )));
 
+    connect( _openGLWidget, SIGNAL( loadingProgress( const QString& )),
+             this, SLOT( showStatusBarMessage( const QString& )));
+
+    connect( _openGLWidget, SIGNAL( dataLoaded( void )),
+             this, SLOT( dataLoadingFinished( void )));
+
+    connect( _openGLWidget, SIGNAL( networkUpdated( void )),
+             this, SLOT( networkUpdated( void )));
+
     QAction* actionTogglePause = new QAction(this);
     actionTogglePause->setShortcut( Qt::Key_Space );
 
@@ -274,10 +286,40 @@ namespace visimpl
     _ui->statusbar->showMessage( message );
   }
 
+  void MainWindow::dataLoadingFinished( void )
+  {
+    _endTimeLabel->setText(
+          QString::number( (double)_openGLWidget->player( )->endTime( )));
+
+    // Spikes may have been paged once fully loaded.
+    _summary->spikeStore( _openGLWidget->spikeStore( ));
+    _summary->UpdateSpikes( );
+  }
+
+  void MainWindow::networkUpdated( void )
+  {
+    // Streamed neurons publish a new snapshot, keyframes and producer are
+    // rebuilt over it by the widget.
+    auto network = _openGLWidget->network( );
+    _gidDictionary = network->gidDictionary( );
+
+    _selectionManager->updateGIDs( network );
+
+    if( _summary )
+    {
+      _summary->gidDictionary( _gidDictionary );
+      _summary->UpdateSpikes( );
+    }
+  }
+
   void MainWindow::configureComponents( void )
   {
     _domainManager = _openGLWidget->domainManager( );
-    _selectionManager->setGIDs( _domainManager->gids( ));
+
+    _gidDictionary = _domainManager->network( )->gidDictionary( );
+
+    _selectionManager->setGIDs( _domainManager->network( ), { },
+                                _gidDictionary );
 
     _subsetEvents = _openGLWidget->player( )->data( )->subsetsEvents( );
   }
@@ -287,9 +329,10 @@ namespace visimpl
                                    const std::string& reportLabel,
                                    const std::string& subsetEventFile )
   {
-    _openGLWidget->loadData( fileName,
-                             simil::TDataType::TBlueConfig,
-                             simulationType, reportLabel );
+    if( !_openGLWidget->loadData( fileName,
+                                  simil::TDataType::TBlueConfig,
+                                  simulationType, reportLabel ))
+      return;
 
     configureComponents( );
 
@@ -374,10 +417,11 @@ namespace visimpl
                                  const std::string& activityFile,
                                  const std::string& subsetEventFile )
   {
-    _openGLWidget->loadData( networkFile,
-                             simil::TDataType::THDF5,
-                             simulationType,
-                             activityFile );
+    if( !_openGLWidget->loadData( networkFile,
+                                  simil::TDataType::THDF5,
+                                  simulationType,
+                                  activityFile ))
+      return;
 
     configureComponents( );
 
@@ -391,10 +435,11 @@ namespace visimpl
                                 const std::string& activityFile,
                                 const std::string& subsetEventFile )
   {
-    _openGLWidget->loadData( networkFile,
-                             simil::TDataType::TCSV,
-                             simulationType,
-                             activityFile );
+    if( !_openGLWidget->loadData( networkFile,
+                                  simil::TDataType::TCSV,
+                                  simulationType,
+                                  activityFile ))
+      return;
 
     configureComponents( );
 
@@ -457,15 +502,31 @@ namespace visimpl
       return;
 
     if( !append )
+    {
       _subsetEvents->clear( );
-
+      _subsetIndex.reset( );
+    }
 
     if( filePath.find( "json" ) != std::string::npos )
     {
       std::cout << "Loading JSON file: " << filePath << std::endl;
-      _subsetEvents->loadJSON( filePath );
 
-      _subsetImporter->reload( _subsetEvents );
+      // A single index backs the session, appended files go through SimIL.
+      std::shared_ptr< SubsetIndex > index;
+      if( !_subsetIndex )
+        index = SubsetIndex::load( filePath );
+
+      if( index )
+      {
+        index->exportEvents( _subsetEvents );
+        _subsetIndex = index;
+      }
+      else
+        _subsetEvents->loadJSON( filePath );
+
+      _subsetImporter->reload( _subsetEvents, _subsetIndex );
+      if( _summary )
+        _summary->subsetIndex( _subsetIndex );
 
       _openGLWidget->subsetEventsManager( _subsetEvents );
       _openGLWidget->showEventsActivityLabels( _ui->actionShowEventsActivity->isChecked( ));
@@ -475,7 +536,9 @@ namespace visimpl
       std::cout << "Loading H5 file: " << filePath << std::endl;
       _subsetEvents->loadH5( filePath );
 
-      _subsetImporter->reload( _subsetEvents );
+      _subsetImporter->reload( _subsetEvents, _subsetIndex );
+      if( _summary )
+        _summary->subsetIndex( _subsetIndex );
 
       _openGLWidget->subsetEventsManager( _subsetEvents );
       _openGLWidget->showEventsActivityLabels( _ui->actionShowEventsActivity->isChecked( ));
@@ -697,6 +760,10 @@ namespace visimpl
     _goToButton = new QPushButton( );
     _goToButton->setText( QString( "Play at..." ));
 
+    _abRepeatButton = new QPushButton( );
+    _abRepeatButton->setText( QString( "A-B" ));
+    _abRepeatButton->setToolTip( tr( "Set loop start, then loop end" ));
+
     QIcon stopIcon;
     QIcon nextIcon;
     QIcon prevIcon;
@@ -740,6 +807,7 @@ namespace visimpl
     dockLayout->addWidget( stopButton, row, 11, 1, 1 );
     dockLayout->addWidget( nextButton, row, 12, 1, 1 );
     dockLayout->addWidget( _goToButton, row, 13, 1, 1 );
+    dockLayout->addWidget( _abRepeatButton, row, 14, 1, 1 );
 
     connect( _playButton, SIGNAL( clicked( )),
              this, SLOT( PlayPause( )));
@@ -762,6 +830,9 @@ namespace visimpl
     connect( _goToButton, SIGNAL( clicked( )),
              this, SLOT( playAtButtonClicked( )));
 
+    connect( _abRepeatButton, SIGNAL( clicked( )),
+             this, SLOT( abRepeatButtonClicked( )));
+
   //  connect( _simSlider, SIGNAL( sliderMoved( )),
   //             this, SLOT( PlayAt( )));
 
@@ -822,7 +893,7 @@ namespace visimpl
     _timeStepsPSBox->setMaximumWidth( 100 );
 
     _stepByStepDurationBox = new QDoubleSpinBox( );
-    _stepByStepDurationBox->setMinimum( 0.5 );
+    _stepByStepDurationBox->setMinimum( 0.01 );
     _stepByStepDurationBox->setMaximum( 50 );
     _stepByStepDurationBox->setSingleStep( 1.0 );
     _stepByStepDurationBox->setDecimals( 3 );
@@ -1248,7 +1319,10 @@ namespace visimpl
 
       std::cout << "Creating summary..." << std::endl;
 
-      _summary->Init( spikesPlayer->data( ));
+      _summary->subsetIndex( _subsetIndex );
+      _summary->spikeStore( _openGLWidget->spikeStore( ));
+      _summary->Init( spikesPlayer->data( ), _gidDictionary,
+                      _openGLWidget->spikeIndex( ));
 
       _summary->simulationPlayer( _openGLWidget->player( ));
     }
@@ -1334,6 +1408,36 @@ namespace visimpl
     return _openGLWidget->circuitScaleFactor( );
   }
 
+  void MainWindow::spikeMemoryBudget( size_t bytes )
+  {
+    _openGLWidget->spikeMemoryBudget( bytes );
+  }
+
+  void MainWindow::keyframeMemoryBudget( size_t bytes )
+  {
+    _openGLWidget->keyframeMemoryBudget( bytes );
+  }
+
+  void MainWindow::simulationThread( unsigned int depth, float leadTime )
+  {
+    _openGLWidget->simulationThread( depth, leadTime );
+  }
+
+  void MainWindow::frameBudget( float milliseconds )
+  {
+    _openGLWidget->frameBudget( milliseconds );
+  }
+
+  void MainWindow::lutSize( unsigned int entries )
+  {
+    _openGLWidget->lutSize( entries );
+  }
+
+  void MainWindow::updateThreads( unsigned int threads )
+  {
+    _openGLWidget->updateThreads( threads );
+  }
+
   void MainWindow::changeCircuitScaleValue( void )
   {
     auto scale = _openGLWidget->circuitScaleFactor( );
@@ -1534,6 +1638,63 @@ namespace visimpl
   }
 
 
+  void MainWindow::abRepeatButtonClicked( void )
+  {
+    if( !_openGLWidget || !_openGLWidget->player( ))
+      return;
+
+    auto player = _openGLWidget->player( );
+    auto toSlider = [ & ]( float time )
+    {
+      float percentage = ( time - player->startTime( )) /
+                         ( player->endTime( ) - player->startTime( ));
+      return int( percentage * ( _simSlider->maximum( ) -
+                                 _simSlider->minimum( ))) +
+             _simSlider->minimum( );
+    };
+
+    // Third click clears the loop.
+    if( _openGLWidget->playbackMode( ) == TPlaybackMode::AB_REPEAT )
+    {
+      _openGLWidget->playbackMode( TPlaybackMode::CONTINUOUS );
+      _clearABRepeat( );
+      return;
+    }
+
+    float time = _openGLWidget->currentTime( );
+
+    if( !_abBeginSet )
+    {
+      _abBegin = time;
+      _abBeginSet = true;
+
+      _simSlider->markers( toSlider( _abBegin ), -1 );
+      _abRepeatButton->setText( QString( "A-B: set B" ));
+      return;
+    }
+
+    _abBeginSet = false;
+
+    if( time == _abBegin )
+    {
+      _clearABRepeat( );
+      return;
+    }
+
+    _openGLWidget->abRepeat( _abBegin, time );
+
+    _simSlider->markers( toSlider( _abBegin ), toSlider( time ));
+    _abRepeatButton->setText( QString( "A-B: clear" ));
+  }
+
+  void MainWindow::_clearABRepeat( void )
+  {
+    _abBeginSet = false;
+
+    _simSlider->markers( -1, -1 );
+    _abRepeatButton->setText( QString( "A-B" ));
+  }
+
   void MainWindow::playAtButtonClicked( void )
   {
     if( !_openGLWidget || !_openGLWidget->player( ))
@@ -1821,8 +1982,19 @@ namespace visimpl
 
     for( auto groupName : groups )
     {
-      auto subset = _subsetEvents->getSubset( groupName );
-      TGIDUSet gids( subset.begin( ), subset.end( ));
+      TGIDUSet gids;
+      uint64_t position = _subsetIndex ?
+          _subsetIndex->findSubset( groupName ) : 0;
+      if( _subsetIndex && position < _subsetIndex->subsetsNumber( ))
+      {
+        auto range = _subsetIndex->subsetGids( position );
+        gids.insert( range.first, range.second );
+      }
+      else
+      {
+        auto subset = _subsetEvents->getSubset( groupName );
+        gids.insert( subset.begin( ), subset.end( ));
+      }
 
       GIDUSet filteredGIDs;
       for( auto gid : gids )
@@ -1971,6 +2143,7 @@ namespace visimpl
     if( _openGLWidget )
     {
       _openGLWidget->Stop( );
+      _clearABRepeat( );
       _playButton->setIcon( _playIcon );
       _startTimeLabel->setText(
             QString::number( (double)_openGLWidget->player( )->startTime( )));
@@ -2045,6 +2218,7 @@ namespace visimpl
       _playButton->setIcon( _pauseIcon );
 
       _openGLWidget->PlayAt( percentage );
+      _clearABRepeat( );
 
       _openGLWidget->playbackMode( TPlaybackMode::CONTINUOUS );
 
@@ -2080,6 +2254,7 @@ namespace visimpl
       _playButton->setIcon( _pauseIcon );
 
       _openGLWidget->PlayAt( percentage );
+      _clearABRepeat( );
 
       _openGLWidget->playbackMode( TPlaybackMode::CONTINUOUS );
 
@@ -2107,6 +2282,7 @@ namespace visimpl
       _playButton->setIcon( _pauseIcon );
       _openGLWidget->player( )->Play( );
       _openGLWidget->PreviousStep( );
+      _clearABRepeat( );
     }
   }
 
@@ -2120,6 +2296,7 @@ namespace visimpl
       _playButton->setIcon( _pauseIcon );
       _openGLWidget->player( )->Play( );
       _openGLWidget->NextStep( );
+      _clearABRepeat( );
 
     }
   }
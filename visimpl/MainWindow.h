@@ -66,7 +66,6 @@ namespace visimpl
     ~MainWindow( void );
 
     void init( const std::string& zeqUri = "" );
-    void showStatusBarMessage ( const QString& message );
 
     void openBlueConfig( const std::string& fileName,
                          simil::TSimulationType simulationType,
@@ -91,6 +90,8 @@ namespace visimpl
 
   public slots:
 
+    void showStatusBarMessage ( const QString& message );
+
     void openBlueConfigThroughDialog( void );
     void openCSVFilesThroughDialog( void );
     void openHDF5ThroughDialog( void );
@@ -125,6 +126,13 @@ namespace visimpl
     void setCircuitSizeScaleFactor( vec3 );
     vec3 getCircuitSizeScaleFactor( void ) const;
 
+    void spikeMemoryBudget( size_t bytes );
+    void keyframeMemoryBudget( size_t bytes );
+    void simulationThread( unsigned int depth, float leadTime );
+    void frameBudget( float milliseconds );
+    void lutSize( unsigned int entries );
+    void updateThreads( unsigned int threads );
+
     void showInactive( bool show );
 
     void changeCircuitScaleValue( void );
@@ -159,6 +167,8 @@ namespace visimpl
   protected slots:
 
     void configureComponents( void );
+    void dataLoadingFinished( void );
+    void networkUpdated( void );
     void importVisualGroups( void );
 
     void addGroupControls( const std::string& name, unsigned int index,
@@ -174,6 +184,7 @@ namespace visimpl
 
     void completedStep( void );
     void playAtButtonClicked( void );
+    void abRepeatButtonClicked( void );
 
     void clippingPlanesReset( void );
 
@@ -188,6 +199,7 @@ namespace visimpl
 
     void _initSimControlDock( void );
     void _initPlaybackDock( void );
+    void _clearABRepeat( void );
     void _initSummaryWidget( void );
 
     void _configurePlayer( void );
@@ -233,17 +245,23 @@ namespace visimpl
     OpenGLWidget* _openGLWidget;
     DomainManager* _domainManager;
     simil::SubsetEventManager* _subsetEvents;
+    TGIDDictionaryPtr _gidDictionary;
+    TSubsetIndexPtr _subsetIndex;
     visimpl::Summary* _summary;
 
     scoop::ColorPalette _colorPalette;
 
     QDockWidget* _simulationDock;
-    QSlider* _simSlider;
+    CustomSlider* _simSlider;
     QPushButton* _playButton;
     QLabel* _startTimeLabel;
     QLabel* _endTimeLabel;
     QPushButton* _repeatButton;
     QPushButton* _goToButton;
+    QPushButton* _abRepeatButton;
+
+    float _abBegin;
+    bool _abBeginSet;
 
     QDockWidget* _simConfigurationDock;
 
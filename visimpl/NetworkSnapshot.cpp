@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "NetworkSnapshot.h"
+
+namespace visimpl
+{
+
+  NetworkSnapshot::NetworkSnapshot( TGIDSet gids, tGidPosMap positions )
+  : _gids( std::move( gids ))
+  , _positions( std::move( positions ))
+  , _gidDictionary( std::make_shared< const GIDDictionary >( _gids ))
+  { }
+
+  TNetworkSnapshotPtr NetworkSnapshot::create( const TGIDSet& gids,
+                                               const TPosVect& positions,
+                                               const vec3& scale )
+  {
+    tGidPosMap gidPositions;
+    gidPositions.reserve( positions.size( ));
+
+    auto gidit = gids.begin( );
+    for( const auto& pos : positions )
+    {
+      vec3 position( pos.x( ), pos.y( ), pos.z( ));
+
+      gidPositions.insert( std::make_pair( *gidit, position * scale ));
+      ++gidit;
+    }
+
+    return std::make_shared< const NetworkSnapshot >( gids,
+                                                      std::move( gidPositions ));
+  }
+
+  TNetworkSnapshotPtr NetworkSnapshot::append( const TGIDSet& gids,
+                                               const tGidPosMap& positions ) const
+  {
+    // Streamed gids mostly follow the known ones, hinting at the end keeps
+    // each insertion constant.
+    TGIDSet newGids( _gids );
+    for( auto gid : gids )
+      newGids.insert( newGids.end( ), gid );
+
+    tGidPosMap newPositions;
+    newPositions.reserve( _positions.size( ) + positions.size( ));
+    newPositions.insert( _positions.begin( ), _positions.end( ));
+    newPositions.insert( positions.begin( ), positions.end( ));
+
+    return std::make_shared< const NetworkSnapshot >( std::move( newGids ),
+                                                      std::move( newPositions ));
+  }
+
+  const TGIDSet& NetworkSnapshot::gids( void ) const
+  {
+    return _gids;
+  }
+
+  const tGidPosMap& NetworkSnapshot::positions( void ) const
+  {
+    return _positions;
+  }
+
+  size_t NetworkSnapshot::size( void ) const
+  {
+    return _gids.size( );
+  }
+
+  TGIDDictionaryPtr NetworkSnapshot::gidDictionary( void ) const
+  {
+    return _gidDictionary;
+  }
+
+  size_t NetworkSnapshot::memoryUsage( void ) const
+  {
+    // Tree nodes hold three links and a color, hash nodes one link and the
+    // cached hash.
+    size_t setNode = sizeof( TGIDSet::value_type ) + 4 * sizeof( void* );
+    size_t mapNode = sizeof( tGidPosMap::value_type ) + 2 * sizeof( void* );
+
+    return _gids.size( ) * setNode +
+        _positions.size( ) * mapNode +
+        _positions.bucket_count( ) * sizeof( void* );
+  }
+
+}
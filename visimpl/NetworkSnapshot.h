@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_NETWORKSNAPSHOT__
+#define __VISIMPL_NETWORKSNAPSHOT__
+
+#include <memory>
+
+#include "types.h"
+
+namespace visimpl
+{
+  class NetworkSnapshot;
+
+  typedef std::shared_ptr< const NetworkSnapshot > TNetworkSnapshotPtr;
+
+  /*
+   * Immutable gids and scaled positions of the loaded network, with their
+   * dense gid dictionary. A single snapshot is shared by the OpenGL widget,
+   * the domain manager, particle sources, the selection manager and every
+   * component indexing neurons. Data changes build a new snapshot that
+   * replaces the previous one as a whole, holders of the old one keep a
+   * consistent view until they switch.
+   */
+  class NetworkSnapshot
+  {
+  public:
+
+    NetworkSnapshot( TGIDSet gids, tGidPosMap positions );
+
+    static TNetworkSnapshotPtr create( const TGIDSet& gids,
+                                       const TPosVect& positions,
+                                       const vec3& scale );
+
+    // New snapshot holding this network plus the given neurons.
+    TNetworkSnapshotPtr append( const TGIDSet& gids,
+                                const tGidPosMap& positions ) const;
+
+    const TGIDSet& gids( void ) const;
+    const tGidPosMap& positions( void ) const;
+
+    size_t size( void ) const;
+
+    // Dense gid dictionary of the network, built along with the snapshot.
+    TGIDDictionaryPtr gidDictionary( void ) const;
+
+    // Heap bytes held by the gid set and the position map, counted from
+    // their node and bucket numbers.
+    size_t memoryUsage( void ) const;
+
+  protected:
+
+    const TGIDSet _gids;
+    const tGidPosMap _positions;
+    const TGIDDictionaryPtr _gidDictionary;
+  };
+
+}
+
+#endif /* __VISIMPL_NETWORKSNAPSHOT__ */
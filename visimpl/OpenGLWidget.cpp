@@ -30,11 +30,13 @@
 #include <sstream>
 #include <string>
 #include <iostream>
+#include <limits>
 #include <glm/glm.hpp>
 
 #include <map>
 
 #include "MainWindow.h"
+#include "AllocationCounter.h"
 
 #include "prefr/PrefrShaders.h"
 #include "prefr/ColorSource.h"
@@ -102,6 +104,29 @@ namespace visimpl
   , _pickRenderer( nullptr )
   , _simulationType( simil::TSimulationType::TSimNetwork )
   , _player( nullptr )
+  , _dataLoader( nullptr )
+  , _loadingData( nullptr )
+  , _loadedHorizon( 0.0f )
+  , _spikeStore( nullptr )
+  , _spikeMemoryBudget( 0 )
+  , _keyframes( nullptr )
+  , _keyframeMemoryBudget( 64 * 1024 * 1024 )
+  , _restoreGeneration( 0 )
+  , _pendingInput( false )
+  , _pendingBegin( 0.0f )
+  , _pendingEnd( 0.0f )
+  , _pendingDone( 0 )
+  , _producer( nullptr )
+  , _producerDepth( 8 )
+  , _producerLeadTime( 0.0f )
+  , _producerSynced( false )
+  , _producerFrame( 0 )
+  , _producerTime( 0.0f )
+  , _producerDeltaTime( 0.0f )
+  , _lutSize( prefr::ColorOperationModel::DEFAULT_LUT_SIZE )
+  , _updateThreads( 0 )
+  , _frameAllocations( 0 )
+  , _producerAllocations( 0 )
 #ifdef SIMIL_WITH_REST_API
   , _importer( nullptr )
 #endif
@@ -121,10 +146,18 @@ namespace visimpl
   , _sbsEndTime( 0 )
   , _sbsCurrentTime( 0 )
   , _sbsCurrentRenderDelta( 0 )
+  , _sbsCurrentDone( 0 )
   , _sbsPlaying( false )
   , _sbsFirstStep( true )
   , _sbsNextStep( false )
   , _sbsPrevStep( false )
+  , _abBegin( 0.0f )
+  , _abEnd( 0.0f )
+  , _abCurrentTime( 0 )
+  , _abCurrentSpike( 0 )
+  , _abCachedDecay( 0.0f )
+  , _abCached( false )
+  , _abRestart( false )
   , _simDeltaTime( 0.125f )
   , _timeStepsPerSecond( 2.0f )
   , _simTimePerSecond( 0.5f )
@@ -156,7 +189,6 @@ namespace visimpl
   , _currentAttrib( T_TYPE_MORPHO )
   , _showActiveEvents( true )
   , _subsetEvents( nullptr )
-  , _deltaEvents( 0.125f )
   , _domainManager( nullptr )
   , _selectedPickingSingle( 0 )
   {
@@ -190,7 +222,7 @@ namespace visimpl
       "margin: 10px;"
       " border-radius: 10px;}" );
     _fpsLabel->setVisible( _showFps );
-    _fpsLabel->setMaximumSize( 100, 50 );
+    _fpsLabel->setMaximumSize( 300, 50 );
 
     _labelCurrentTime = new QLabel( );
     _labelCurrentTime->setStyleSheet(
@@ -247,6 +279,18 @@ namespace visimpl
     if( _particleSystem )
       delete _particleSystem;
 
+    if( _dataLoader )
+      delete _dataLoader;
+
+    if( _spikeStore )
+      delete _spikeStore;
+
+    if( _keyframes )
+      delete _keyframes;
+
+    if( _producer )
+      delete _producer;
+
     if( _player )
       delete _player;
 
@@ -255,7 +299,7 @@ namespace visimpl
 
 
 
-  void OpenGLWidget::loadData( const std::string& fileName,
+  bool OpenGLWidget::loadData( const std::string& fileName,
                                const simil::TDataType fileType,
                                simil::TSimulationType simulationType,
                                const std::string& report)
@@ -267,11 +311,51 @@ namespace visimpl
 
     _deltaTime = 0.5f;
 
-    simil::SpikeData* spikeData = new simil::SpikeData( fileName, fileType, report );
-    spikeData->reduceDataToGIDS( );
+    // Only the network is waited for, it is rendered while spikes keep
+    // arriving in the background. No events are processed meanwhile, so
+    // nothing can re-enter the loading.
+    _dataLoader = new DataLoader( fileName, fileType, report,
+                                  _spikeMemoryBudget );
+
+    connect( _dataLoader, SIGNAL( progress( const QString& )),
+             this, SIGNAL( loadingProgress( const QString& )));
+    connect( _dataLoader, SIGNAL( spikesLoaded( void )),
+             this, SLOT( _appendLoadedSpikes( void )));
+    connect( _dataLoader, SIGNAL( finished( void )),
+             this, SLOT( _loadingFinished( void )));
+
+    {
+      ScopedPhase phase( "Load network" );
+
+      _dataLoader->start( );
+      _loadingData = _dataLoader->waitData( );
+    }
+
+    if( !_loadingData )
+    {
+      std::cerr << "Could not load " << fileName << std::endl;
+
+      delete _dataLoader;
+      _dataLoader = nullptr;
+
+      return false;
+    }
+
+    _loadedHorizon = _loadingData->endTime( );
+
+    _openSpikeStore( );
+
+    if( !_spikeStore )
+    {
+      ScopedPhase indexPhase( "SpikeTimeIndex build" );
+
+      _spikeIndex = std::make_shared< SpikeTimeIndex >(
+          _loadingData->spikes( ), _loadingData->startTime( ),
+          std::max( _loadingData->endTime( ), _dataLoader->totalTime( )));
+    }
 
     simil::SpikesPlayer* spPlayer = new simil::SpikesPlayer( );
-    spPlayer->LoadData( spikeData );
+    spPlayer->LoadData( _loadingData );
     _player = spPlayer;
 //    _player->deltaTime( _deltaTime );
 
@@ -319,6 +403,7 @@ namespace visimpl
 
 
     createParticleSystem(  );
+    _createKeyframes( );
 
     simulationDeltaTime( std::get< T_DELTATIME >( config ) );
     simulationStepsPerSecond( std::get< T_STEPS_PER_SEC >( config ) );
@@ -331,6 +416,95 @@ namespace visimpl
     this->_paint = true;
     update( );
 
+    if( _dataLoader->isFinished( ))
+      _loadingFinished( );
+    else
+      _appendLoadedSpikes( );
+
+    return true;
+  }
+
+  void OpenGLWidget::_appendLoadedSpikes( void )
+  {
+    if( !_player || !_dataLoader )
+      return;
+
+    TSpikes spikes;
+    float horizon = _loadedHorizon;
+    bool appended = false;
+
+    while( _dataLoader->takeSpikes( spikes, horizon ))
+    {
+      _loadingData->addSpikes( spikes );
+      appended = true;
+    }
+
+    if( !appended )
+      return;
+
+    _loadedHorizon = horizon;
+    _loadingData->setEndTime( std::max( _loadingData->endTime( ),
+                                        _loadedHorizon ));
+
+    if( _spikeIndex )
+      _spikeIndex->update( );
+
+    _abCached = false;
+
+    // Appending may reallocate the spike container; re-seek the player.
+    _player->GoTo( _player->currentTime( ));
+  }
+
+  void OpenGLWidget::_openSpikeStore( void )
+  {
+    if( _spikeStore || !_dataLoader->paged( ))
+      return;
+
+    _spikeStore = new SpikePageStore( _dataLoader->sourceFiles( ),
+                                      _dataLoader->dataType( ),
+                                      _dataLoader->report( ),
+                                      _spikeMemoryBudget );
+
+    if( !_spikeStore->open( ))
+    {
+      std::cerr << "Could not open paged spike store." << std::endl;
+      delete _spikeStore;
+      _spikeStore = nullptr;
+      return;
+    }
+
+    // Spikes may turn out to be paged only once loaded, then the index
+    // built over the delivered ones is dropped.
+    _spikeIndex.reset( );
+    _loadedHorizon = _spikeStore->endTime( );
+    _loadingData->setEndTime( std::max( _loadingData->endTime( ),
+                                        _loadedHorizon ));
+  }
+
+  void OpenGLWidget::_loadingFinished( void )
+  {
+    if( !_player || !_dataLoader )
+      return;
+
+    _appendLoadedSpikes( );
+    _openSpikeStore( );
+
+    _loadingData->setEndTime( std::max( _loadingData->endTime( ),
+                                        _dataLoader->totalTime( )));
+
+    _dataLoader->deleteLater( );
+    _dataLoader = nullptr;
+
+    // The end time is known now, spread the keyframes over it.
+    _createKeyframes( );
+    _createProducer( );
+
+    uint64_t spikesNumber = _spikeStore ? _spikeStore->spikesNumber( ) :
+        _loadingData->spikes( ).size( );
+
+    emit loadingProgress( tr( "Loaded " ) + QString::number( spikesNumber ) +
+                          tr( " spikes" ));
+    emit dataLoaded( );
   }
 
 #ifdef SIMIL_WITH_REST_API
@@ -433,6 +607,11 @@ namespace visimpl
     if( !_player || !_player->isPlaying( ) || !_particleSystem->run( ))
       return;
 
+    // Wait for the loader when playback reaches the loaded time horizon.
+    if( _dataLoader &&
+        _player->currentTime( ) + _player->deltaTime( ) > _loadedHorizon )
+      return;
+
     float prevTime = _player->currentTime( );
 
     if( _backtrace )
@@ -443,13 +622,121 @@ namespace visimpl
       _backtrace = false;
     }
 
-    _player->Frame( );
+    // Catch up when rendering fell behind, without wrapping around a loop
+    // or going past the loaded spikes.
+    unsigned int steps = _governor.steps( _elapsedTimeSimAcc,
+                                          _simPeriodMicroseconds );
+    float horizon = _dataLoader ? _loadedHorizon : _player->endTime( );
+    while( steps > 1 && prevTime + steps * _player->deltaTime( ) > horizon )
+      --steps;
+
+    for( unsigned int i = 0; i < steps; ++i )
+      _player->Frame( );
 
     float currentTime = _player->currentTime( );
 
-    _domainManager->processInput( _player->spikesNow( ), prevTime,
-                             currentTime, false );
+    if( steps > 1 )
+      _governor.coalesced( currentTime - prevTime - _player->deltaTime( ));
+
+    if( _keyframes )
+      _keyframes->advance( currentTime );
+
+    // Batches follow the player frame by frame since the last restart. Only
+    // a seek, loop wrap or delta time change breaks the sequence.
+    bool continuous = _producer && _producerSynced &&
+                      prevTime == _producerTime && currentTime >= prevTime &&
+                      _player->deltaTime( ) == _producerDeltaTime;
+
+    const ActivationBatch* batch = nullptr;
+    if( continuous )
+    {
+      // Drop batches of frames replayed while the producer was behind.
+      while(( batch = _producer->front( )) && batch->frame < _producerFrame )
+        _producer->pop( );
+    }
+
+    bool prepared = batch && steps == 1 && batch->frame == _producerFrame;
 
+    if( _producer )
+    {
+      if( continuous )
+      {
+        _producerFrame += steps;
+      }
+      else
+      {
+        _producer->restart( currentTime, _player->deltaTime( ),
+                            _player->endTime( ));
+        _producerFrame = 0;
+        _producerSynced = true;
+      }
+
+      _producerTime = currentTime;
+      _producerDeltaTime = _player->deltaTime( );
+    }
+
+    if( prepared && batch->activity.size( ) <= _governor.spikeBudget( ))
+    {
+      _domainManager->processActivity( batch->activity, currentTime, false );
+      _producer->pop( );
+    }
+    else
+    {
+      if( prepared )
+        _producer->pop( );
+
+      _pendingBegin = prevTime;
+      if( currentTime < prevTime )
+      {
+        // Loop wrap, the tail of the previous pass is input of this frame
+        // too and comes before the pending range.
+        float endTime = _player->endTime( );
+        _inputSpikes( prevTime, endTime, endTime, 0,
+                      std::numeric_limits< uint64_t >::max( ));
+        _pendingBegin = _player->startTime( );
+      }
+
+      _pendingEnd = currentTime;
+      _pendingDone = 0;
+      _pendingInput = true;
+
+      _processPendingInput( );
+    }
+  }
+
+  void OpenGLWidget::_processPendingInput( bool flush )
+  {
+    if( !_pendingInput )
+      return;
+
+    // Ranges are fetched again every time, appended spikes may have moved
+    // the container and pages may have been evicted since the frame was
+    // deferred.
+    uint64_t total = _countSpikes( _pendingBegin, _pendingEnd );
+    uint64_t done = std::min( _pendingDone, total );
+
+    uint64_t count = total - done;
+    if( !flush )
+      count = std::min( count, _governor.spikeBudget( ));
+
+    auto start = std::chrono::steady_clock::now( );
+
+    _inputSpikes( _pendingBegin, _pendingEnd, _pendingEnd, done, count );
+
+    _governor.inputCost( count, std::chrono::duration< double, std::micro >(
+        std::chrono::steady_clock::now( ) - start ).count( ));
+
+    _pendingDone = done + count;
+
+    if( _pendingDone >= total )
+      _pendingInput = false;
+    else
+      _governor.deferred( );
+  }
+
+  void OpenGLWidget::_flushPendingInput( void )
+  {
+    _processPendingInput( true );
   }
 
   void OpenGLWidget::_configurePreviousStep( void )
@@ -470,10 +757,8 @@ namespace visimpl
 
     _backtraceSimulation( );
 
-    _sbsStepSpikes = _player->spikesBetween( _sbsBeginTime, _sbsEndTime );
-
     _sbsCurrentTime = _sbsBeginTime;
-    _sbsCurrentSpike = _sbsStepSpikes.first;
+    _sbsCurrentDone = 0;
 
     _sbsFirstStep = false;
     _sbsPlaying = true;
@@ -496,10 +781,8 @@ namespace visimpl
       _backtraceSimulation( );
     }
 
-    _sbsStepSpikes = _player->spikesBetween( _sbsBeginTime, _sbsEndTime );
-
     _sbsCurrentTime = _sbsBeginTime;
-    _sbsCurrentSpike = _sbsStepSpikes.first;
+    _sbsCurrentDone = 0;
 
     _sbsFirstStep = false;
     _sbsPlaying = true;
@@ -527,34 +810,242 @@ namespace visimpl
 
       double nextTime = _sbsCurrentTime + _sbsCurrentRenderDelta;
 
-      auto spikeIt = _sbsCurrentSpike;
-      while( spikeIt->first < nextTime  &&
-             spikeIt - _sbsStepSpikes.first < _sbsStepSpikes.second - _sbsStepSpikes.first )
-      {
-        ++spikeIt;
-      }
+      // This render frame covers the spikes before frameEnd, fetched again
+      // every frame as nothing keeps them valid in between. Dense steps are
+      // spread over more render frames, the step time only advances up to
+      // the first spike left for the next one.
+      float frameEnd = nextTime;
+      uint64_t budget = _governor.spikeBudget( );
+      uint64_t skip = _sbsCurrentDone;
+      uint64_t total = 0;
+      bool cut = false;
+
+      _visitSpikes( _sbsCurrentTime, frameEnd,
+          [ & ]( const simil::SpikesCRange& range )
+          {
+            uint64_t size = range.second - range.first;
+            if( !cut && total + size > skip + budget )
+            {
+              auto next = range.first + ( skip + budget - total );
+              nextTime = std::max( _sbsCurrentTime, ( double ) next->first );
+              cut = true;
+            }
+            total += size;
+          });
+
+      _sbsCurrentRenderDelta = nextTime - _sbsCurrentTime;
+
+      uint64_t count = total > skip ? std::min( total - skip, budget ) : 0;
+      uint64_t atNext = 0;
 
-      if( spikeIt != _sbsCurrentSpike )
+      if( count > 0 )
       {
-        simil::SpikesCRange frameSpikes = std::make_pair( _sbsCurrentSpike, spikeIt );
-        _domainManager->processInput( frameSpikes, _sbsCurrentTime, nextTime, false );
+        auto start = std::chrono::steady_clock::now( );
+
+        atNext = _inputSpikes( _sbsCurrentTime, frameEnd, nextTime, skip,
+                               count );
+
+        _governor.inputCost( count,
+                             std::chrono::duration< double, std::micro >(
+                                 std::chrono::steady_clock::now( ) - start ).count( ));
       }
 
+      // Spikes sharing the time of the first one left are skipped next.
+      _sbsCurrentDone = !cut ? 0 :
+          ( nextTime <= _sbsCurrentTime ? skip : 0 ) + atNext;
       _sbsCurrentTime = nextTime;
-      _sbsCurrentSpike = spikeIt;
     }
 
   }
 
+  void OpenGLWidget::_configureABRepeatFrame( void )
+  {
+    if( !_player || !_player->isPlaying( ) || !_particleSystem->run( ))
+      return;
+
+    if( !_abCached || _abCachedDecay != _domainManager->decay( ))
+      _cacheABRepeat( );
+
+    // The player stays parked, the loop restarts from the cached state
+    // without seeking or replaying the decay window.
+    if( _abRestart )
+    {
+      _domainManager->processActivity( _abInitialActivity, _abBegin, true );
+
+      _abCurrentTime = _abBegin;
+      _abCurrentSpike = 0;
+      _abRestart = false;
+    }
+
+    double nextTime = std::min( _abCurrentTime + _player->deltaTime( ),
+                                ( double ) _abEnd );
+
+    auto first = _abSpikes.cbegin( ) + _abCurrentSpike;
+    auto last = first;
+    while( last != _abSpikes.cend( ) && last->first < nextTime )
+      ++last;
+
+    if( first != last )
+      _domainManager->processInput( std::make_pair( first, last ),
+                                    _abCurrentTime, nextTime, false );
+
+    _abCurrentSpike = last - _abSpikes.cbegin( );
+    _abCurrentTime = nextTime;
+
+    if( _abCurrentTime >= _abEnd )
+      _abRestart = true;
+  }
+
+  void OpenGLWidget::_cacheABRepeat( void )
+  {
+    float decay = _domainManager->decay( );
+
+    _abSpikes.clear( );
+    _visitSpikes( _abBegin, _abEnd, [ this ]( const simil::SpikesCRange& range )
+    {
+      _abSpikes.insert( _abSpikes.end( ), range.first, range.second );
+    });
+
+    _restoreActivity( _abBegin, _abInitialActivity );
+
+    _abCachedDecay = decay;
+    _abCached = true;
+  }
+
+  void OpenGLWidget::_exitABRepeat( bool resume )
+  {
+    if( _playbackMode != TPlaybackMode::AB_REPEAT )
+      return;
+
+    _playbackMode = TPlaybackMode::CONTINUOUS;
+
+    TSpikes( ).swap( _abSpikes );
+    TLastSpikes( ).swap( _abInitialActivity );
+    _abCached = false;
+
+    // Particles already show the state at the loop time, continue from it.
+    if( resume && _player )
+      _player->GoTo( _abCurrentTime );
+  }
+
   void OpenGLWidget::_backtraceSimulation( void )
   {
     float endTime = _player->currentTime( );
-    float startTime = std::max( 0.0f, endTime - _domainManager->decay( ));
-    simil::SpikesCRange context =
-        _player->spikesBetween( startTime, endTime );
 
-    if( context.first != context.second )
-      _domainManager->processInput( context, startTime, endTime, true );
+    _restoreActivity( endTime, _restoredActivity );
+    _domainManager->processActivity( _restoredActivity, endTime, true );
+  }
+
+  void OpenGLWidget::_restoreActivity( float time, TLastSpikes& activity )
+  {
+    float decay = _domainManager->decay( );
+
+    if( _keyframes && _keyframes->activity( time, decay, activity ))
+      return;
+
+    // Replay the decay window keeping the latest spike of every neuron,
+    // the same state the keyframes hold.
+    activity.clear( );
+
+    auto snapshot = network( );
+    if( !snapshot )
+      return;
+
+    auto dictionary = snapshot->gidDictionary( );
+    if( _restoreStamp.size( ) != dictionary->size( ))
+    {
+      _restoreStamp.assign( dictionary->size( ), 0 );
+      _restoreSlot.assign( dictionary->size( ), 0 );
+      _restoreGeneration = 0;
+    }
+
+    if( ++_restoreGeneration == 0 )
+    {
+      std::fill( _restoreStamp.begin( ), _restoreStamp.end( ), 0 );
+      _restoreGeneration = 1;
+    }
+
+    // Spikes arrive in time order, later ones overwrite the neuron slot.
+    _visitSpikes( std::max( 0.0f, time - decay ), time,
+        [ & ]( const simil::SpikesCRange& range )
+        {
+          for( auto spike = range.first; spike != range.second; ++spike )
+          {
+            uint32_t idx = dictionary->index( spike->second );
+            if( idx == GIDDictionary::INVALID )
+              continue;
+
+            if( _restoreStamp[ idx ] == _restoreGeneration )
+            {
+              activity[ _restoreSlot[ idx ]].second = spike->first;
+              continue;
+            }
+
+            _restoreStamp[ idx ] = _restoreGeneration;
+            _restoreSlot[ idx ] = activity.size( );
+            activity.emplace_back( spike->second, spike->first );
+          }
+        });
+  }
+
+  void OpenGLWidget::_visitSpikes( float begin, float end,
+      const std::function< void( const simil::SpikesCRange& )>& visitor )
+  {
+    if( _spikeStore )
+      _spikeStore->visitSpikes( begin, end, visitor );
+    else if( _spikeIndex )
+      visitor( _spikeIndex->spikesBetween( begin, end ));
+    else
+      visitor( _player->spikesBetween( begin, end ));
+  }
+
+  uint64_t OpenGLWidget::_countSpikes( float begin, float end )
+  {
+    if( end <= begin )
+      return 0;
+
+    if( _spikeStore )
+      return _spikeStore->lowerBound( end ) - _spikeStore->lowerBound( begin );
+
+    auto spikes = _spikeIndex ? _spikeIndex->spikesBetween( begin, end ) :
+        _player->spikesBetween( begin, end );
+    return spikes.second - spikes.first;
+  }
+
+  uint64_t OpenGLWidget::_inputSpikes( float begin, float end, float inputEnd,
+                                       uint64_t skip, uint64_t count )
+  {
+    uint64_t atEnd = 0;
+
+    // Every page is its own input frame, pages come in time order so the
+    // latest spike of a neuron still wins.
+    _visitSpikes( begin, end, [ & ]( const simil::SpikesCRange& range )
+    {
+      uint64_t size = range.second - range.first;
+      if( skip >= size )
+      {
+        skip -= size;
+        return;
+      }
+
+      auto first = range.first + skip;
+      auto last = first + std::min( count, uint64_t( range.second - first ));
+      skip = 0;
+
+      if( first == last )
+        return;
+
+      count -= last - first;
+
+      _domainManager->processInput( std::make_pair( first, last ),
+                                    begin, inputEnd, false );
+
+      atEnd += last - std::lower_bound( first, last, inputEnd,
+                                        []( const Spike& spike, float time )
+                                        { return spike.first < time; });
+    });
+
+    return atEnd;
   }
 
   void OpenGLWidget::changeShader( int shaderIndex )
@@ -593,39 +1084,43 @@ namespace visimpl
 
   void OpenGLWidget::createParticleSystem( )
   {
+    ScopedPhase phase( "OpenGLWidget::createParticleSystem" );
+
     makeCurrent( );
     prefr::Config::init( );
 
-    // Initialize shader
-    _shaderParticlesDefault = new reto::ShaderProgram( );
-    _shaderParticlesDefault->loadVertexShaderFromText( prefr::prefrVertexShader );
-    _shaderParticlesDefault->loadFragmentShaderFromText( prefr::prefrFragmentShaderDefault );
-    _shaderParticlesDefault->compileAndLink( );
-    _shaderParticlesDefault->autocatching( );
-
-    _shaderParticlesCurrent = _shaderParticlesDefault;
-    _currentShader = T_SHADER_DEFAULT;
-
-    // Initialize shader
-    _shaderParticlesSolid = new reto::ShaderProgram( );
-    _shaderParticlesSolid->loadVertexShaderFromText( prefr::prefrVertexShader );
-    _shaderParticlesSolid->loadFragmentShaderFromText( prefr::prefrFragmentShaderSolid );
-    _shaderParticlesSolid->compileAndLink( );
-    _shaderParticlesSolid->autocatching( );
-
-
-    _shaderPicking = new prefr::RenderProgram( );
-    _shaderPicking->loadVertexShaderFromText( prefr::prefrVertexShaderPicking );
-    _shaderPicking->loadFragmentShaderFromText( prefr::prefrFragmentShaderPicking );
-    _shaderPicking->compileAndLink( );
-
-    _shaderClippingPlanes = new reto::ShaderProgram( );
-    _shaderClippingPlanes->loadVertexShaderFromText( prefr::planeVertCode );
-    _shaderClippingPlanes->loadFragmentShaderFromText( prefr::planeFragCode );
-    _shaderClippingPlanes->compileAndLink( );
-    _shaderClippingPlanes->autocatching( );
-
-
+    {
+      ScopedPhase shaderPhase( "Shader compilation" );
+
+      // Initialize shader
+      _shaderParticlesDefault = new reto::ShaderProgram( );
+      _shaderParticlesDefault->loadVertexShaderFromText( prefr::prefrVertexShader );
+      _shaderParticlesDefault->loadFragmentShaderFromText( prefr::prefrFragmentShaderDefault );
+      _shaderParticlesDefault->compileAndLink( );
+      _shaderParticlesDefault->autocatching( );
+
+      _shaderParticlesCurrent = _shaderParticlesDefault;
+      _currentShader = T_SHADER_DEFAULT;
+
+      // Initialize shader
+      _shaderParticlesSolid = new reto::ShaderProgram( );
+      _shaderParticlesSolid->loadVertexShaderFromText( prefr::prefrVertexShader );
+      _shaderParticlesSolid->loadFragmentShaderFromText( prefr::prefrFragmentShaderSolid );
+      _shaderParticlesSolid->compileAndLink( );
+      _shaderParticlesSolid->autocatching( );
+
+
+      _shaderPicking = new prefr::RenderProgram( );
+      _shaderPicking->loadVertexShaderFromText( prefr::prefrVertexShaderPicking );
+      _shaderPicking->loadFragmentShaderFromText( prefr::prefrFragmentShaderPicking );
+      _shaderPicking->compileAndLink( );
+
+      _shaderClippingPlanes = new reto::ShaderProgram( );
+      _shaderClippingPlanes->loadVertexShaderFromText( prefr::planeVertCode );
+      _shaderClippingPlanes->loadFragmentShaderFromText( prefr::planeFragCode );
+      _shaderClippingPlanes->compileAndLink( );
+      _shaderClippingPlanes->autocatching( );
+    }
 
     unsigned int maxParticles =
         std::max(( unsigned int ) 100000, ( unsigned int ) _player->gids( ).size( ));
@@ -635,13 +1130,16 @@ namespace visimpl
     _particleSystem = new prefr::ParticleSystem( maxParticles, _camera );
     _flagResetParticles = true;
 
-    _domainManager = new DomainManager( _particleSystem, _gids);
+    _domainManager = new DomainManager( _particleSystem, network( ));
 
 #ifdef SIMIL_USE_BRION
-    _domainManager->init( _gidPositions, _player->data( )->blueConfig( ));
+    _domainManager->init( _player->data( )->blueConfig( ));
 #else
-    _domainManager->init( _gidPositions );
+    _domainManager->init( );
 #endif
+    _domainManager->lutSize( _lutSize );
+    if( _updateThreads > 0 )
+      _domainManager->updateThreads( _updateThreads );
     _domainManager->initializeParticleSystem( );
 
     _pickRenderer =
@@ -780,7 +1278,7 @@ namespace visimpl
     }
 
     if( _particleSystem )
-      _particleSystem->update( 0.0f );
+      _domainManager->updateParticles( 0.0f );
   }
 
     void OpenGLWidget::paintGL( void )
@@ -796,6 +1294,11 @@ namespace visimpl
 
       _deltaTime = elapsedMicroseconds * 0.000001;
 
+      SimulationProducer* producer = _producer;
+      const uint64_t producerAllocated =
+          producer ? producer->allocationCount( ) : 0;
+      const uint64_t allocated = allocations::count( );
+
       if( _player && _player->isPlaying( ))
       {
         _elapsedTimeSimAcc += elapsedMicroseconds;
@@ -817,13 +1320,24 @@ namespace visimpl
 
         if( _particleSystem )
         {
+          // Particle update and paint cost, input is measured on its own.
+          double renderCost = 0.0;
+
           if( _player && _player->isPlaying( ))
           {
             switch( _playbackMode )
             {
               // Continuous mode (Default)
               case TPlaybackMode::CONTINUOUS:
-                if( _elapsedTimeSimAcc >= _simPeriodMicroseconds )
+                // Simulation time stays frozen until a deferred frame is
+                // completely processed.
+                if( _pendingInput )
+                {
+                  _processPendingInput( );
+                  _elapsedTimeSimAcc = 0.0f;
+                  _elapsedTimeRenderAcc = 0.0f;
+                }
+                else if( _elapsedTimeSimAcc >= _simPeriodMicroseconds )
                 {
                   _configureSimulationFrame( );
                   _updateEventLabelsVisibility( );
@@ -831,6 +1345,15 @@ namespace visimpl
                   _elapsedTimeSimAcc = 0.0f;
                 }
                 break;
+              case TPlaybackMode::AB_REPEAT:
+                if( _elapsedTimeSimAcc >= _simPeriodMicroseconds )
+                {
+                  _configureABRepeatFrame( );
+                  _updateEventLabelsVisibility( );
+
+                  _elapsedTimeSimAcc = 0.0f;
+                }
+                break;
               // Step by step mode
               case TPlaybackMode::STEP_BY_STEP:
                 if( _sbsPrevStep )
@@ -849,13 +1372,16 @@ namespace visimpl
             }
 
 
-            if( _elapsedTimeRenderAcc >= _renderPeriodMicroseconds )
+            if( _elapsedTimeRenderAcc >= _renderPeriodMicroseconds &&
+                !_pendingInput )
             {
+              auto renderStart = std::chrono::steady_clock::now( );
               double renderDelta = 0;
 
               switch( _playbackMode )
               {
               case TPlaybackMode::CONTINUOUS:
+              case TPlaybackMode::AB_REPEAT:
                 renderDelta = _elapsedTimeRenderAcc * _simTimePerSecond * 0.000001;
                 break;
               case  TPlaybackMode::STEP_BY_STEP:
@@ -868,14 +1394,23 @@ namespace visimpl
 
               _updateParticles( renderDelta );
               _elapsedTimeRenderAcc = 0.0f;
+
+              renderCost += std::chrono::duration< double, std::micro >(
+                  std::chrono::steady_clock::now( ) - renderStart ).count( );
             } // elapsed > render period
 
           } // if player && player->isPlayint
 
           _paintPlanes( );
 
+          auto paintStart = std::chrono::steady_clock::now( );
+
           _paintParticles( );
 
+          renderCost += std::chrono::duration< double, std::micro >(
+              std::chrono::steady_clock::now( ) - paintStart ).count( );
+          _governor.renderCost( renderCost );
+
           if( _flagPickingSingle )
           {
             _pickSingle( );
@@ -893,18 +1428,35 @@ namespace visimpl
         _player->sendCurrentTimestamp( );
     #endif
 
-        emit updateSlider( _player->GetRelativeTime( ));
+        if( _playbackMode == TPlaybackMode::AB_REPEAT )
+          emit updateSlider(( _abCurrentTime - _player->startTime( )) /
+                            ( _player->endTime( ) - _player->startTime( )));
+        else
+          emit updateSlider( _player->GetRelativeTime( ));
 
 
         if( _showCurrentTime )
         {
-          _labelCurrentTime->setText( tr( "t=") + QString::number( _player->currentTime( )));
+          _labelCurrentTime->setText( tr( "t=") + QString::number( currentTime( )));
         }
       }
 
 
 
 
+      // The producer share is reported apart, so steady playback can be
+      // checked to allocate nothing while the producer runs ahead.
+      if( allocations::enabled( ))
+      {
+        uint64_t frameAllocated = allocations::count( ) - allocated;
+        uint64_t producerDelta = ( producer && producer == _producer ) ?
+            producer->allocationCount( ) - producerAllocated : 0;
+
+        _frameAllocations += frameAllocated > producerDelta ?
+                             frameAllocated - producerDelta : 0;
+        _producerAllocations += producerDelta;
+      }
+
       #define FRAMES_PAINTED_TO_MEASURE_FPS 10
       if( _showFps && _frameCount >= FRAMES_PAINTED_TO_MEASURE_FPS )
       {
@@ -924,10 +1476,37 @@ namespace visimpl
 
           if( _showFps )
           {
-            _fpsLabel->setText( QString::number( fps ) + QString( " FPS" ));
+            QString text = QString::number( fps ) + QString( " FPS" );
+
+            // Simulated time coalesced into fewer steps and frames whose
+            // input was spread over more frames by the governor.
+            if( _governor.coalescedTime( ) > 0.0 )
+              text += QString( ", " ) +
+                      QString::number( _governor.coalescedTime( ), 'g', 3 ) +
+                      QString( " coalesced" );
+
+            if( _governor.deferredFrames( ) > 0 )
+              text += QString( ", " ) +
+                      QString::number( _governor.deferredFrames( )) +
+                      QString( " deferred" );
+
+            if( allocations::enabled( ))
+              text += QString( "\n" ) +
+                      QString::number( double( _frameAllocations ) /
+                                       _frameCount, 'g', 3 ) +
+                      QString( " allocs/frame, " ) +
+                      QString::number( double( _producerAllocations ) /
+                                       _frameCount, 'g', 3 ) +
+                      QString( " producer" );
+
+            _fpsLabel->setText( text );
             _fpsLabel->adjustSize( );
           }
 
+          _governor.resetStatistics( );
+          _frameAllocations = 0;
+          _producerAllocations = 0;
+
         }
 
         _frameCount = 0;
@@ -1013,7 +1592,7 @@ namespace visimpl
       updateCameraBoundingBox( );
 
       _particleSystem->run( true );
-      _particleSystem->update( 0.0f );
+      _domainManager->updateParticles( 0.0f );
 
       _flagUpdateSelection = false;
       _flagUpdateRender = true;
@@ -1050,7 +1629,7 @@ namespace visimpl
       updateCameraBoundingBox( );
 
       _particleSystem->run( true );
-      _particleSystem->update( 0.0f );
+      _domainManager->updateParticles( 0.0f );
 
       _flagUpdateGroups = false;
       _flagUpdateRender = true;
@@ -1069,7 +1648,7 @@ namespace visimpl
         updateCameraBoundingBox( );
 
         _particleSystem->run( true );
-        _particleSystem->update( 0.0f );
+        _domainManager->updateParticles( 0.0f );
 
         _flagUpdateAttributes = false;
         _flagUpdateRender = true;
@@ -1083,30 +1662,78 @@ namespace visimpl
 
   void OpenGLWidget::_updateData( void )
   {
-      _gids = _player->gids( );
-      _positions = _player->positions( );
+      ScopedPhase phase( "OpenGLWidget::_updateData" );
 
-      _gidPositions.clear( );
+      _setNetwork( NetworkSnapshot::create( _player->gids( ),
+                                            _player->positions( ),
+                                            _scaleFactor ));
+  }
 
-      _gidPositions.reserve( _positions.size( ));
-      auto gidit = _gids.begin( );
-      for( auto pos : _positions )
-      {
-        vec3 position( pos.x( ), pos.y( ), pos.z( ));
+  void OpenGLWidget::_updateNewData( void )
+  {
+    _flagNewData = false;
 
-        _gidPositions.insert( std::make_pair( *gidit, position * _scaleFactor ));
-        ++gidit;
-      }
+    // Spikes are consumed straight from the player, only new neurons need
+    // to reach the particle system.
+    TGIDSet newGids;
+    tGidPosMap newPositions;
+    if( !_collectNewData( newGids, newPositions ))
+      return;
 
+    _setNetwork( network( )->append( newGids, newPositions ));
+
+    _domainManager->appendData( network( ), newGids );
+    _createKeyframes( );
+    _createProducer( );
+    _focusOn( _domainManager->boundingBox( ));
+
+    _flagUpdateRender = true;
+
+    emit networkUpdated( );
   }
 
-  void OpenGLWidget::_updateNewData( void )
+  bool OpenGLWidget::_collectNewData( TGIDSet& newGids,
+                                      tGidPosMap& newPositions ) const
   {
-      _updateData();
-      _domainManager->updateData(_gids, _gidPositions );
-      _focusOn( _domainManager->boundingBox( ));
-      _flagNewData = false;
-      _flagUpdateRender = true;
+    const auto& gids = _player->gids( );
+    const auto current = network( );
+    const auto& knownGids = current->gids( );
+    if( gids.size( ) <= knownGids.size( ))
+      return false;
+
+    const auto& positions = _player->positions( );
+
+    auto addNeuron = [ & ]( unsigned int gid, const vmml::Vector3f& pos )
+    {
+      newGids.insert( newGids.end( ), gid );
+      newPositions.insert( std::make_pair(
+          gid, vec3( pos.x( ), pos.y( ), pos.z( )) * _scaleFactor ));
+    };
+
+    // Streamed neurons usually come with increasing gids: only the tail of
+    // the player's set, whose positions follow the known ones, is new.
+    auto first = knownGids.empty( ) ?
+        gids.begin( ) : gids.upper_bound( *knownGids.rbegin( ));
+    size_t tailSize = std::distance( first, gids.end( ));
+
+    if( knownGids.size( ) + tailSize == gids.size( ))
+    {
+      size_t index = knownGids.size( );
+      for( auto gid = first; gid != gids.end( ); ++gid, ++index )
+        addNeuron( *gid, positions[ index ]);
+    }
+    else
+    {
+      auto pos = positions.begin( );
+      for( auto gid : gids )
+      {
+        if( current->positions( ).find( gid ) == current->positions( ).end( ))
+          addNeuron( gid, *pos );
+        ++pos;
+      }
+    }
+
+    return !newGids.empty( );
   }
 
   void OpenGLWidget::setMode( int mode )
@@ -1220,7 +1847,7 @@ namespace visimpl
     {
 
      _updateData();
-      _domainManager->updateData(_gids, _gidPositions );
+      _domainManager->updateData( network( ));
       _focusOn( _domainManager->boundingBox( ));
     }
 
@@ -1233,56 +1860,147 @@ namespace visimpl
     return _scaleFactor;
   }
 
-  void OpenGLWidget::_updateParticles( float renderDelta )
+  void OpenGLWidget::spikeMemoryBudget( size_t bytes )
   {
-    if( _player->isPlaying( ) || _firstFrame )
-    {
+    _spikeMemoryBudget = bytes;
 
-      _particleSystem->update( renderDelta );
-      _firstFrame = false;
-    }
+    if( _spikeStore )
+      _spikeStore->memoryBudget( bytes );
   }
 
+  size_t OpenGLWidget::spikeMemoryBudget( void ) const
+  {
+    return _spikeMemoryBudget;
+  }
 
+  void OpenGLWidget::keyframeMemoryBudget( size_t bytes )
+  {
+    _keyframeMemoryBudget = bytes;
 
-  void OpenGLWidget::_updateEventLabelsVisibility( void )
+    if( _keyframes )
+      _keyframes->memoryBudget( bytes );
+  }
+
+  size_t OpenGLWidget::keyframeMemoryBudget( void ) const
   {
-    std::vector< bool > visibility = _activeEventsAt( _player->currentTime( ));
+    return _keyframeMemoryBudget;
+  }
 
-    unsigned int counter = 0;
-    for( auto showLabel : visibility )
-    {
-      EventLabel& labelObjects = _eventLabels[ counter ];
-//      QString style( "border: 1px solid " + showLabel ? "white;" : "black;" );
-      QGraphicsOpacityEffect* effect = new QGraphicsOpacityEffect( );
-      effect->setOpacity( showLabel ? 1.0 : 0.5 );
-      labelObjects.upperWidget->setGraphicsEffect( effect );
-      labelObjects.upperWidget->update( );
-      ++counter;
-    }
+  void OpenGLWidget::simulationThread( unsigned int depth, float leadTime )
+  {
+    _producerDepth = depth;
+    _producerLeadTime = leadTime;
 
+    if( _spikeIndex )
+      _createProducer( );
+  }
 
+  void OpenGLWidget::frameBudget( float milliseconds )
+  {
+    _governor.budget( milliseconds );
+  }
 
+  float OpenGLWidget::frameBudget( void ) const
+  {
+    return _governor.budget( );
   }
 
+  unsigned int OpenGLWidget::simulationThreadDepth( void ) const
+  {
+    return _producerDepth;
+  }
+
+  float OpenGLWidget::simulationThreadLeadTime( void ) const
+  {
+    return _producerLeadTime;
+  }
+
+  void OpenGLWidget::lutSize( unsigned int entries )
+  {
+    _lutSize = entries;
+
+    if( _domainManager )
+      _domainManager->lutSize( entries );
+  }
+
+  unsigned int OpenGLWidget::lutSize( void ) const
+  {
+    return _lutSize;
+  }
 
-  std::vector< bool > OpenGLWidget::_activeEventsAt( float time )
+  void OpenGLWidget::updateThreads( unsigned int threads )
   {
-    std::vector< bool > result( _eventLabels.size( ), false);
+    _updateThreads = threads;
 
-    float totalTime = _player->endTime( ) - _player->startTime( );
+    if( _domainManager )
+      _domainManager->updateThreads( threads );
+  }
 
-    double perc = time / totalTime;
-    unsigned int counter = 0;
-    for( auto event : _eventsActivation )
+  unsigned int OpenGLWidget::updateThreads( void ) const
+  {
+    return _domainManager ? _domainManager->updateThreads( ) : _updateThreads;
+  }
+
+  void OpenGLWidget::_createProducer( void )
+  {
+    if( _producer )
+      delete _producer;
+    _producer = nullptr;
+
+    _producerSynced = false;
+
+    // The producer reads the spike index unlocked, so it only runs once
+    // every spike has been loaded. Paged stores are not thread safe.
+    if( !_spikeIndex || _dataLoader || _producerDepth == 0 )
+      return;
+
+    _producer = new SimulationProducer(
+        _spikeIndex,
+        network( )->gidDictionary( ),
+        _producerDepth, _producerLeadTime );
+    _producer->start( );
+  }
+
+  void OpenGLWidget::_createKeyframes( void )
+  {
+    if( _keyframes )
+      delete _keyframes;
+    _keyframes = nullptr;
+
+    if( !_spikeIndex || _keyframeMemoryBudget == 0 )
+      return;
+
+    _keyframes = new ActivityKeyframes(
+        _spikeIndex,
+        network( )->gidDictionary( ),
+        _loadingData->startTime( ), _loadingData->endTime( ),
+        _keyframeMemoryBudget );
+  }
+
+  void OpenGLWidget::_updateParticles( float renderDelta )
+  {
+    if( _player->isPlaying( ) || _firstFrame )
     {
-      unsigned int position = perc * event.size( );
-      result[ counter ] = event[ position ];
 
-      ++counter;
+      _domainManager->updateParticles( renderDelta );
+      _firstFrame = false;
     }
+  }
 
-    return result;
+
+
+  void OpenGLWidget::_updateEventLabelsVisibility( void )
+  {
+    // Labels are only touched when their event starts or ends.
+    if( !_eventTimeline.seek( currentTime( )))
+      return;
+
+    for( auto event : _eventTimeline.toggled( ))
+    {
+      EventLabel& labelObjects = _eventLabels[ event ];
+      labelObjects.opacity->setOpacity(
+          _eventTimeline.active( event ) ? 1.0 : 0.5 );
+    }
   }
 
   void OpenGLWidget::resizeGL( int w , int h )
@@ -1548,7 +2266,7 @@ namespace visimpl
     evec3 normal = - _planeNormalLeft;
     normal.normalize( );
 
-    auto positions = _domainManager->positions( );
+    const auto& positions = _domainManager->positions( );
 
     result.reserve( positions.size( ));
 
@@ -1791,8 +2509,37 @@ namespace visimpl
 
   void OpenGLWidget::playbackMode( TPlaybackMode mode )
   {
-    if( mode != TPlaybackMode::AB_REPEAT )
-      _playbackMode = mode;
+    if( mode == TPlaybackMode::AB_REPEAT )
+      return;
+
+    _flushPendingInput( );
+    _exitABRepeat( true );
+    _playbackMode = mode;
+  }
+
+  void OpenGLWidget::abRepeat( float begin, float end )
+  {
+    if( !_player )
+      return;
+
+    if( end < begin )
+      std::swap( begin, end );
+
+    begin = std::max( begin, _player->startTime( ));
+    end = std::min( end, _player->endTime( ));
+
+    if( end <= begin )
+      return;
+
+    _abBegin = begin;
+    _abEnd = end;
+    _abCurrentTime = begin;
+
+    _abCached = false;
+    _abRestart = true;
+
+    _pendingInput = false;
+    _playbackMode = TPlaybackMode::AB_REPEAT;
   }
 
   bool OpenGLWidget::completedStep( void )
@@ -1811,6 +2558,8 @@ namespace visimpl
     {
     case TPlaybackMode::STEP_BY_STEP:
       return _sbsCurrentTime;
+    case TPlaybackMode::AB_REPEAT:
+      return _abCurrentTime;
     default:
       return _player->currentTime( );
     }
@@ -1821,6 +2570,38 @@ namespace visimpl
     return _domainManager;
   }
 
+  TNetworkSnapshotPtr OpenGLWidget::network( void ) const
+  {
+    return std::atomic_load( &_network );
+  }
+
+  TSpikeTimeIndexPtr OpenGLWidget::spikeIndex( void ) const
+  {
+    return _spikeIndex;
+  }
+
+  SpikePageStore* OpenGLWidget::spikeStore( void ) const
+  {
+    return _spikeStore;
+  }
+
+  void OpenGLWidget::_setNetwork( TNetworkSnapshotPtr network )
+  {
+    std::atomic_store( &_network, network );
+
+    // Before sharing, the widget and the domain manager held their own gids
+    // and positions, plus a raw positions vector and the selection manager
+    // gid set.
+    size_t shared = network->memoryUsage( );
+    size_t copies = 2 * shared + network->size( ) *
+        ( sizeof( vmml::Vector3f ) + sizeof( uint32_t ) + 4 * sizeof( void* ));
+
+    std::cout << "Network snapshot: " << network->size( ) << " neurons, "
+              << shared / ( 1024 * 1024 ) << " MB shared ( "
+              << copies / ( 1024 * 1024 ) << " MB as per-component copies )"
+              << std::endl;
+  }
+
   void OpenGLWidget::subsetEventsManager( simil::SubsetEventManager* manager )
   {
     _subsetEvents = manager;
@@ -1854,16 +2635,11 @@ namespace visimpl
     }
 
     _eventLabels.clear( );
-    _eventsActivation.clear( );
+    _eventTimeline.clear( );
 
 
     unsigned int row = 0;
 
-    float totalTime = _player->endTime( ) - _player->startTime( );
-
-    unsigned int activitySize =
-        std::ceil( totalTime / _deltaEvents );
-
     scoop::ColorPalette::Colors colors = _colorPalette.colors( );
 
     for( auto name : eventNames )
@@ -1897,9 +2673,15 @@ namespace visimpl
       labelLayout->addWidget( label );
       container->setLayout( labelLayout );
 
+      // Events start inactive, the timeline reports when they toggle.
+      QGraphicsOpacityEffect* opacity = new QGraphicsOpacityEffect( );
+      opacity->setOpacity( 0.5 );
+      container->setGraphicsEffect( opacity );
+
       labelObjects.frame = frame;
       labelObjects.label = label;
       labelObjects.upperWidget = container;
+      labelObjects.opacity = opacity;
 
       _eventLabels.push_back( labelObjects );
 
@@ -1907,13 +2689,13 @@ namespace visimpl
 
       _eventLabelsLayout->addWidget( container, row, 10, 2, 1 );
 
-      std::vector< bool > activity( activitySize );
-
-      _eventsActivation.push_back(
-          _subsetEvents->eventActivity( name, _deltaEvents, totalTime ));
+      _eventTimeline.addEvent( _subsetEvents->getEvent( name ));
 
       ++row;
     }
+
+    if( _player )
+      _updateEventLabelsVisibility( );
   }
 
   void OpenGLWidget::Play( void )
@@ -1948,6 +2730,8 @@ namespace visimpl
   {
     if( _player )
     {
+      _exitABRepeat( false );
+      _pendingInput = false;
       _player->Stop( );
       _flagResetParticles = true;
       _firstFrame = true;
@@ -1966,6 +2750,8 @@ namespace visimpl
   {
     if( _player )
     {
+      _exitABRepeat( false );
+      _pendingInput = false;
       _particleSystem->run( false );
       _flagResetParticles = true;
 
@@ -1982,6 +2768,8 @@ namespace visimpl
     if( _player )
     {
       bool playing = _player->isPlaying( );
+      _exitABRepeat( false );
+      _pendingInput = false;
       _player->Stop( );
       if( playing )
         _player->Play( );
@@ -1993,6 +2781,9 @@ namespace visimpl
 
   void OpenGLWidget::PreviousStep( void )
   {
+    _flushPendingInput( );
+    _exitABRepeat( true );
+
     if( _playbackMode != TPlaybackMode::STEP_BY_STEP )
     {
       _playbackMode = TPlaybackMode::STEP_BY_STEP;
@@ -2005,6 +2796,9 @@ namespace visimpl
 
   void OpenGLWidget::NextStep( void )
   {
+    _flushPendingInput( );
+    _exitABRepeat( true );
+
     if( _playbackMode != TPlaybackMode::STEP_BY_STEP )
     {
       _playbackMode = TPlaybackMode::STEP_BY_STEP;
@@ -2035,7 +2829,13 @@ namespace visimpl
       gcolors.Insert( c.first, gColor );
     }
 
-    _domainManager->modelSelectionBase( )->color = gcolors;
+    auto model = _domainManager->modelSelectionBase( );
+    model->color = gcolors;
+    model->bake( );
+
+    if( model->lutSize( ) > 0 )
+      std::cout << "Color mapping table error: " << model->colorError( )
+                << std::endl;
 
     _flagUpdateRender = true;
 
@@ -2070,7 +2870,13 @@ namespace visimpl
     {
       newSize.Insert( s.first, s.second );
     }
-    _domainManager->modelSelectionBase( )->size = newSize;
+    auto model = _domainManager->modelSelectionBase( );
+    model->size = newSize;
+    model->bake( );
+
+    if( model->lutSize( ) > 0 )
+      std::cout << "Size function table error: " << model->sizeError( )
+                << std::endl;
 
     _flagUpdateRender = true;
   }
@@ -26,7 +26,9 @@
 #include <QOpenGLFunctions>
 #include <QOpenGLWidget>
 #include <QLabel>
+#include <QGraphicsOpacityEffect>
 #include <chrono>
+#include <functional>
 #include <unordered_set>
 #include <queue>
 
@@ -48,6 +50,12 @@
 #include "render/Plane.h"
 
 #include "DomainManager.h"
+#include "NetworkSnapshot.h"
+#include "ActivityKeyframes.h"
+#include "SimulationProducer.h"
+#include "FrameGovernor.h"
+#include "EventTimeline.h"
+#include "DataLoader.h"
 
 #include <sumrice/sumrice.h>
 #include <scoop/scoop.h>
@@ -98,6 +106,7 @@ namespace visimpl
       QWidget* upperWidget;
       QFrame* frame;
       QLabel* label;
+      QGraphicsOpacityEffect* opacity;
 
     };
 
@@ -107,7 +116,7 @@ namespace visimpl
     ~OpenGLWidget( void );
 
     void createParticleSystem(  );
-    void loadData( const std::string& fileName,
+    bool loadData( const std::string& fileName,
                    const simil::TDataType = simil::TDataType::TBlueConfig,
                    simil::TSimulationType simulationType = simil::TSimSpikes,
                    const std::string& report = std::string( "" ));
@@ -124,6 +133,10 @@ namespace visimpl
     TPlaybackMode playbackMode( void );
     void playbackMode( TPlaybackMode mode );
 
+    // Loops [ begin, end ), every iteration restarts from the activity
+    // state at begin, computed once. Leave it through playbackMode( ).
+    void abRepeat( float begin, float end );
+
     bool completedStep( void );
 
     simil::SimulationPlayer* player( );
@@ -136,6 +149,40 @@ namespace visimpl
 
     DomainManager* domainManager( void );
 
+    TNetworkSnapshotPtr network( void ) const;
+
+    // Null when spikes are paged from disk.
+    TSpikeTimeIndexPtr spikeIndex( void ) const;
+
+    // Null unless spikes are paged from disk.
+    SpikePageStore* spikeStore( void ) const;
+
+    void spikeMemoryBudget( size_t bytes );
+    size_t spikeMemoryBudget( void ) const;
+
+    void keyframeMemoryBudget( size_t bytes );
+    size_t keyframeMemoryBudget( void ) const;
+
+    // Frames prepared ahead by the simulation thread, 0 disables it, and
+    // how far ahead in simulation time it may run, 0 for no limit. Each
+    // frame slot keeps up to 8 bytes per neuron firing in its busiest
+    // frame, not counted against the spike memory budget.
+    void simulationThread( unsigned int depth, float leadTime = 0.0f );
+
+    // Target frame time in milliseconds, 0 disables the frame governor.
+    void frameBudget( float milliseconds );
+    float frameBudget( void ) const;
+    unsigned int simulationThreadDepth( void ) const;
+    float simulationThreadLeadTime( void ) const;
+
+    // Entries of the baked color and size tables, 0 for exact curves.
+    void lutSize( unsigned int entries );
+    unsigned int lutSize( void ) const;
+
+    // Particle update threads, 0 for every hardware thread.
+    void updateThreads( unsigned int threads );
+    unsigned int updateThreads( void ) const;
+
     void resetParticles( void );
 
     void SetAlphaBlendingAccumulative( bool accumulative = true );
@@ -154,6 +201,10 @@ namespace visimpl
 
     void pickedSingle( unsigned int );
 
+    void loadingProgress( const QString& message );
+    void dataLoaded( void );
+    void networkUpdated( void );
+
   public slots:
 
     void updateData( void );
@@ -227,6 +278,11 @@ namespace visimpl
 
     GIDVec getPlanesContainedElements( void ) const;
 
+  protected slots:
+
+    void _appendLoadedSpikes( void );
+    void _loadingFinished( void );
+
   protected:
 
     void _resolveFlagsOperations( void );
@@ -251,6 +307,9 @@ namespace visimpl
     void _pickSingle( void );
 
     void _backtraceSimulation( void );
+    void _restoreActivity( float time, TLastSpikes& activity );
+    void _createKeyframes( void );
+    void _createProducer( void );
 
     void _configureSimulationFrame( void );
     void _configureStepByStepFrame( double elapsedRenderTimeMilliseconds );
@@ -258,6 +317,25 @@ namespace visimpl
     void _configurePreviousStep( void );
     void _configureStepByStep( void );
 
+    void _processPendingInput( bool flush = false );
+    void _flushPendingInput( void );
+
+    void _configureABRepeatFrame( void );
+    void _cacheABRepeat( void );
+    void _exitABRepeat( bool resume );
+
+    void _openSpikeStore( void );
+    // Spikes in [ begin, end ), in time order and page by page when paged.
+    void _visitSpikes( float begin, float end,
+                       const std::function< void( const simil::SpikesCRange& )>&
+                         visitor );
+    uint64_t _countSpikes( float begin, float end );
+
+    // Feeds count spikes of [ begin, end ), after the first skip ones, as
+    // input up to inputEnd. Returns how many of them were at inputEnd.
+    uint64_t _inputSpikes( float begin, float end, float inputEnd,
+                           uint64_t skip, uint64_t count );
+
     void _modeChange( void );
     void _attributeChange( void );
 
@@ -266,13 +344,13 @@ namespace visimpl
     void _updateGroupsVisibility( void );
     void _updateAttributes( void );
     void _updateNewData( void );
+    bool _collectNewData( TGIDSet& newGids, tGidPosMap& newPositions ) const;
 
     void _updateData( void );
 
     void _createEventLabels( void );
     void _updateEventLabelsVisibility( void );
 
-    std::vector< bool > _activeEventsAt( float time );
 
     virtual void initializeGL( void );
     virtual void paintGL( void );
@@ -346,6 +424,47 @@ namespace visimpl
     simil::TSimulationType _simulationType;
     simil::SpikesPlayer* _player;
 
+    DataLoader* _dataLoader;
+    simil::SpikeData* _loadingData;
+    float _loadedHorizon;
+
+    SpikePageStore* _spikeStore;
+    TSpikeTimeIndexPtr _spikeIndex;
+    size_t _spikeMemoryBudget;
+
+    ActivityKeyframes* _keyframes;
+    size_t _keyframeMemoryBudget;
+    TLastSpikes _restoredActivity;
+    std::vector< uint32_t > _restoreStamp;
+    std::vector< uint32_t > _restoreSlot;
+    uint32_t _restoreGeneration;
+
+    FrameGovernor _governor;
+
+    // Input range still to be processed, spread over several frames.
+    bool _pendingInput;
+    float _pendingBegin;
+    float _pendingEnd;
+    uint64_t _pendingDone;
+
+    SimulationProducer* _producer;
+    unsigned int _producerDepth;
+    float _producerLeadTime;
+
+    // Next batch frame expected and the player state it continues from.
+    bool _producerSynced;
+    uint64_t _producerFrame;
+    float _producerTime;
+    float _producerDeltaTime;
+
+    unsigned int _lutSize;
+    unsigned int _updateThreads;
+
+    // Heap allocations since the last FPS report of the frames, update
+    // workers included, and of the producer thread. Debug builds only.
+    uint64_t _frameAllocations;
+    uint64_t _producerAllocations;
+
 #ifdef SIMIL_WITH_REST_API
     simil::LoaderSimData* _importer;
 #endif
@@ -379,14 +498,27 @@ namespace visimpl
     double _sbsCurrentTime;
     double _sbsCurrentRenderDelta;
 
-    simil::SpikesCRange _sbsStepSpikes;
-    simil::SpikesCIter _sbsCurrentSpike;
+    // Spikes at the current step time already processed.
+    uint64_t _sbsCurrentDone;
 
     bool _sbsPlaying;
     bool _sbsFirstStep;
     bool _sbsNextStep;
     bool _sbsPrevStep;
 
+    float _abBegin;
+    float _abEnd;
+    double _abCurrentTime;
+
+    // Spikes in [ A, B ) and activity state at A, valid while _abCached.
+    TSpikes _abSpikes;
+    size_t _abCurrentSpike;
+    TLastSpikes _abInitialActivity;
+    float _abCachedDecay;
+
+    bool _abCached;
+    bool _abRestart;
+
     double _simDeltaTime;
     double _timeStepsPerSecond;
     double _simTimePerSecond;
@@ -432,8 +564,7 @@ namespace visimpl
     simil::SubsetEventManager* _subsetEvents;
     std::vector< EventLabel > _eventLabels;
     QGridLayout* _eventLabelsLayout;
-    std::vector< std::vector< bool >> _eventsActivation;
-    float _deltaEvents;
+    EventTimeline _eventTimeline;
 
     DomainManager* _domainManager;
     tBoundingBox _boundingBoxHome;
@@ -443,9 +574,9 @@ namespace visimpl
     QPoint _pickingPosition;
     unsigned int _selectedPickingSingle;
 
-    tGidPosMap _gidPositions;
-    TGIDSet _gids;
-    TPosVect _positions;
+    void _setNetwork( TNetworkSnapshotPtr network );
+
+    TNetworkSnapshotPtr _network;
   };
 
 } // namespace visimpl
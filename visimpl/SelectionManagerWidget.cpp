@@ -195,11 +195,14 @@ namespace visimpl
 
   }
 
-  void SelectionManagerWidget::setGIDs( const TGIDSet& all_,
-                                        const TGIDUSet& selected_ )
+  void SelectionManagerWidget::setGIDs( TNetworkSnapshotPtr network,
+                                        const TGIDUSet& selected_,
+                                        TGIDDictionaryPtr gidDictionary )
   {
-    _gidsAll.clear( );
-    _gidsAll.insert( all_.begin( ), all_.end( ));
+    _network = network;
+
+    // List rows follow the ascending gid order, same as dictionary indices.
+    _gidIndex = gidDictionary ? gidDictionary : _network->gidDictionary( );
 
     _fillLists( );
 
@@ -207,6 +210,16 @@ namespace visimpl
 
   }
 
+  void SelectionManagerWidget::updateGIDs( TNetworkSnapshotPtr network )
+  {
+    TGIDUSet selected_ = _gidsSelected;
+
+    _gidsSelected.clear( );
+    _gidsAvailable.clear( );
+
+    setGIDs( network, selected_ );
+  }
+
   const TGIDUSet& SelectionManagerWidget::selected( void ) const
   {
     return _gidsSelected;
@@ -215,7 +228,12 @@ namespace visimpl
   void SelectionManagerWidget::clearSelection( void )
   {
     _gidsSelected.clear( );
-    _gidsAvailable = _gidsAll;
+    _gidsAvailable.clear( );
+
+    if( !_network )
+      return;
+
+    _gidsAvailable.insert( _network->gids( ).begin( ), _network->gids( ).end( ));
 
     _reloadLists( );
   }
@@ -228,7 +246,11 @@ namespace visimpl
     _gidsSelected = selected_;
 
     _gidsAvailable.clear( );
-    for( auto gid : _gidsAll )
+
+    if( !_network )
+      return;
+
+    for( auto gid : _network->gids( ))
     {
       if( _gidsSelected.find( gid ) == _gidsSelected.end( ))
         _gidsAvailable.insert( gid );
@@ -242,12 +264,7 @@ namespace visimpl
     _modelAvailable->clear( );
     _modelSelected->clear( );
 
-    unsigned int index = 0;
-    GIDVec gids( _gidsAll.size( ));
-    std::copy( _gidsAll.begin( ), _gidsAll.end( ), gids.begin( ));
-    std::sort( gids.begin( ), gids.end( ));
-
-    for( auto gid : gids )
+    for( auto gid : _gidIndex->gids( ))
     {
       QStandardItem* itemAvailable = new QStandardItem( );
       QVariant value = QVariant::fromValue( gid );
@@ -259,10 +276,6 @@ namespace visimpl
 
       _modelAvailable->appendRow( itemAvailable );
       _modelSelected->appendRow( itemSelected );
-
-      _gidIndex.insert( std::make_pair( gid, index ));
-
-      ++index;
     }
 
   }
@@ -270,14 +283,13 @@ namespace visimpl
   void SelectionManagerWidget::_reloadLists( void )
   {
 
-    for( auto gid : _gidsAll )
+    for( auto gid : _network->gids( ))
     {
       bool stateSelected = ( _gidsSelected.find( gid ) != _gidsSelected.end( ));
 
-      auto gidIndex = _gidIndex.find( gid );
-      assert( gidIndex != _gidIndex.end( ));
-
-      unsigned int row = gidIndex->second;
+      unsigned int row = _gidIndex->index( gid );
+      if( row == GIDDictionary::INVALID )
+        continue;
 
       _listViewAvailable->setRowHidden( row, stateSelected );
       _listViewSelected->setRowHidden( row, !stateSelected );
@@ -318,13 +330,12 @@ namespace visimpl
       _gidsAvailable.erase( gid );
       _gidsSelected.insert( gid );
 
-      auto gidIndex = _gidIndex.find( gid );
-      assert( gidIndex != _gidIndex.end( ));
-
-
+      unsigned int row = _gidIndex->index( gid );
+      if( row == GIDDictionary::INVALID )
+        continue;
 
-      _listViewAvailable->setRowHidden( gidIndex->second, true );
-      _listViewSelected->setRowHidden( gidIndex->second, false );
+      _listViewAvailable->setRowHidden( row, true );
+      _listViewSelected->setRowHidden( row, false );
 
     }
 
@@ -350,11 +361,12 @@ namespace visimpl
       _gidsSelected.erase( gid );
       _gidsAvailable.insert( gid );
 
-      auto gidIndex = _gidIndex.find( gid );
-      assert( gidIndex != _gidIndex.end( ));
+      unsigned int row = _gidIndex->index( gid );
+      if( row == GIDDictionary::INVALID )
+        continue;
 
-      _listViewAvailable->setRowHidden( gidIndex->second, false );
-      _listViewSelected->setRowHidden( gidIndex->second, true );
+      _listViewAvailable->setRowHidden( row, false );
+      _listViewSelected->setRowHidden( row, true );
 
     }
 
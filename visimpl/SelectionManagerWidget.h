@@ -32,6 +32,7 @@
 #include <unordered_set>
 
 #include "types.h"
+#include "NetworkSnapshot.h"
 
 namespace visimpl
 {
@@ -55,8 +56,12 @@ namespace visimpl
 
     void init( void );
 
-    void setGIDs( const TGIDSet& all_,
-                  const TGIDUSet& selected_ = { });
+    void setGIDs( TNetworkSnapshotPtr network,
+                  const TGIDUSet& selected_ = { },
+                  TGIDDictionaryPtr gidDictionary = nullptr );
+
+    // Refills the lists for a grown network, keeping the selection.
+    void updateGIDs( TNetworkSnapshotPtr network );
 
     void setSelected( const TGIDUSet& selected_ );
     const TGIDUSet& selected( void ) const;
@@ -95,7 +100,7 @@ namespace visimpl
                       const QString& suffix = "" );
 
 
-    TGIDUSet _gidsAll;
+    TNetworkSnapshotPtr _network;
     TGIDUSet _gidsSelected;
     TGIDUSet _gidsAvailable;
 
@@ -115,7 +120,7 @@ namespace visimpl
     QLabel* _labelAvailable;
     QLabel* _labelSelection;
 
-    TUIntUintMap _gidIndex;
+    TGIDDictionaryPtr _gidIndex;
 
     // Export tab
 
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SimulationProducer.h"
+
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace visimpl
+{
+
+  SimulationProducer::SimulationProducer( TSpikeTimeIndexPtr spikeIndex,
+                                          TGIDDictionaryPtr gidDictionary,
+                                          unsigned int depth,
+                                          float leadTime,
+                                          QObject* parent )
+  : QThread( parent )
+  , _spikeIndex( spikeIndex )
+  , _gidDictionary( gidDictionary )
+  , _leadTime( leadTime )
+  , _ring( std::max( depth, 1u ))
+  , _head( 0 )
+  , _tail( 0 )
+  , _epoch( 0 )
+  , _consumerTime( 0.0f )
+  , _allocations( 0 )
+  , _stop( false )
+  , _restartTime( 0.0f )
+  , _deltaTime( 0.0f )
+  , _endTime( 0.0f )
+  , _generation( 0 )
+  , _stamp( gidDictionary->size( ), 0 )
+  {
+    // Slots grow to the largest batch produced into them and keep that
+    // capacity, reserving every neuron would cost depth times the network
+    // size up front.
+    for( auto& batch : _ring )
+    {
+      batch.epoch = 0;
+      batch.frame = 0;
+      batch.begin = batch.end = 0.0f;
+    }
+  }
+
+  SimulationProducer::~SimulationProducer( void )
+  {
+    stop( );
+  }
+
+  unsigned int SimulationProducer::depth( void ) const
+  {
+    return _ring.size( );
+  }
+
+  float SimulationProducer::leadTime( void ) const
+  {
+    return _leadTime;
+  }
+
+  uint64_t SimulationProducer::allocationCount( void ) const
+  {
+    return _allocations.load( std::memory_order_relaxed );
+  }
+
+  void SimulationProducer::restart( float time, float deltaTime,
+                                    float endTime )
+  {
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      _restartTime = time;
+      _deltaTime = deltaTime;
+      _endTime = endTime;
+
+      // Batches carry the epoch they were produced in, stale ones are
+      // skipped by front( ).
+      _epoch.fetch_add( 1, std::memory_order_release );
+    }
+
+    _consumerTime.store( time, std::memory_order_relaxed );
+    _wake.notify_one( );
+  }
+
+  const ActivationBatch* SimulationProducer::front( void )
+  {
+    const uint32_t epoch = _epoch.load( std::memory_order_acquire );
+    uint64_t tail = _tail.load( std::memory_order_relaxed );
+
+    while( tail != _head.load( std::memory_order_acquire ))
+    {
+      const ActivationBatch& batch = _ring[ tail % _ring.size( )];
+      if( batch.epoch == epoch )
+        return &batch;
+
+      _tail.store( ++tail, std::memory_order_release );
+    }
+
+    return nullptr;
+  }
+
+  void SimulationProducer::pop( void )
+  {
+    uint64_t tail = _tail.load( std::memory_order_relaxed );
+    if( tail == _head.load( std::memory_order_acquire ))
+      return;
+
+    _consumerTime.store( _ring[ tail % _ring.size( )].end,
+                         std::memory_order_relaxed );
+    _tail.store( tail + 1, std::memory_order_release );
+  }
+
+  void SimulationProducer::stop( void )
+  {
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      _stop = true;
+    }
+    _wake.notify_one( );
+
+    wait( );
+  }
+
+  bool SimulationProducer::_ready( float time, float deltaTime,
+                                   float endTime ) const
+  {
+    if( deltaTime <= 0.0f || time >= endTime )
+      return false;
+
+    if( _head.load( std::memory_order_relaxed ) -
+        _tail.load( std::memory_order_acquire ) >= _ring.size( ))
+      return false;
+
+    return _leadTime <= 0.0f ||
+        time < _consumerTime.load( std::memory_order_relaxed ) + _leadTime;
+  }
+
+  void SimulationProducer::run( void )
+  {
+    uint32_t epoch = _epoch.load( std::memory_order_acquire ) - 1;
+    uint64_t frame = 0;
+    float time = 0.0f;
+    float deltaTime = 0.0f;
+    float endTime = 0.0f;
+
+    allocations::track( &_allocations );
+
+    while( true )
+    {
+      {
+        std::unique_lock< std::mutex > lock( _mutex );
+
+        if( _stop )
+          break;
+
+        if( _epoch.load( std::memory_order_acquire ) != epoch )
+        {
+          epoch = _epoch.load( std::memory_order_acquire );
+          frame = 0;
+          time = _restartTime;
+          deltaTime = _deltaTime;
+          endTime = _endTime;
+        }
+
+        // Consumption is not signalled, poll while the ring is full.
+        if( !_ready( time, deltaTime, endTime ))
+        {
+          _wake.wait_for( lock, std::chrono::milliseconds( 1 ));
+          continue;
+        }
+      }
+
+      const uint64_t head = _head.load( std::memory_order_relaxed );
+      ActivationBatch& batch = _ring[ head % _ring.size( )];
+
+      batch.epoch = epoch;
+      batch.frame = frame++;
+      batch.begin = time;
+      batch.end = time + deltaTime;
+      _produce( batch );
+
+      _head.store( head + 1, std::memory_order_release );
+
+      time = batch.end;
+    }
+
+    allocations::track( nullptr );
+  }
+
+  void SimulationProducer::_produce( ActivationBatch& batch )
+  {
+    batch.activity.clear( );
+
+    if( ++_generation == 0 )
+    {
+      std::fill( _stamp.begin( ), _stamp.end( ), 0 );
+      _generation = 1;
+    }
+
+    auto spikes = _spikeIndex->spikesBetween( batch.begin, batch.end );
+
+    // Newest first, the latest spike of every neuron is the one kept.
+    for( auto spike = spikes.second; spike != spikes.first; )
+    {
+      --spike;
+      uint32_t idx = _gidDictionary->index( spike->second );
+      if( idx == GIDDictionary::INVALID || _stamp[ idx ] == _generation )
+        continue;
+
+      _stamp[ idx ] = _generation;
+      batch.activity.emplace_back( spike->second, spike->first );
+    }
+  }
+
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_SIMULATIONPRODUCER__
+#define __VISIMPL_SIMULATIONPRODUCER__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include <QThread>
+
+#include <sumrice/sumrice.h>
+
+#include "types.h"
+#include "ActivityKeyframes.h"
+
+namespace visimpl
+{
+  // Neurons that fired in [ begin, end ) with their latest spike time.
+  // Frame counts the batches produced since the last restart.
+  struct ActivationBatch
+  {
+    uint32_t epoch;
+    uint64_t frame;
+    float begin;
+    float end;
+    TLastSpikes activity;
+  };
+
+  /*
+   * Simulation thread running ahead of the render loop. Batches for the
+   * upcoming playback frames are prepared into a single producer/single
+   * consumer ring, the GUI thread only applies the batch whose frame number
+   * matches the frames it advanced since the last restart. Discontinuities
+   * (seek, delta time change, loop wrap, step by step) are resolved by the
+   * GUI thread calling restart( ), which discards every batch produced
+   * before. A producer running behind is not restarted, the GUI thread
+   * replays those frames and drops their batches once they arrive.
+   */
+  class SimulationProducer : public QThread
+  {
+    Q_OBJECT
+
+  public:
+
+    SimulationProducer( TSpikeTimeIndexPtr spikeIndex,
+                        TGIDDictionaryPtr gidDictionary,
+                        unsigned int depth = 8,
+                        float leadTime = 0.0f,
+                        QObject* parent = nullptr );
+    ~SimulationProducer( void );
+
+    // Ring depth in frames and how far ahead of the consumer, in simulation
+    // time, batches may be produced. A lead time of 0 leaves only the depth.
+    unsigned int depth( void ) const;
+    float leadTime( void ) const;
+
+    // Heap allocations of the producer thread, debug builds only.
+    uint64_t allocationCount( void ) const;
+
+    // GUI thread side.
+    void restart( float time, float deltaTime, float endTime );
+    const ActivationBatch* front( void );
+    void pop( void );
+
+    void stop( void );
+
+  protected:
+
+    void run( void );
+
+    bool _ready( float time, float deltaTime, float endTime ) const;
+    void _produce( ActivationBatch& batch );
+
+    TSpikeTimeIndexPtr _spikeIndex;
+    TGIDDictionaryPtr _gidDictionary;
+
+    float _leadTime;
+
+    std::vector< ActivationBatch > _ring;
+    std::atomic< uint64_t > _head;
+    std::atomic< uint64_t > _tail;
+
+    std::atomic< uint32_t > _epoch;
+    std::atomic< float > _consumerTime;
+    std::atomic< uint64_t > _allocations;
+
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    bool _stop;
+
+    float _restartTime;
+    float _deltaTime;
+    float _endTime;
+
+    // Producer thread dedup scratch.
+    uint32_t _generation;
+    std::vector< uint32_t > _stamp;
+  };
+
+}
+
+#endif /* __VISIMPL_SIMULATIONPRODUCER__ */
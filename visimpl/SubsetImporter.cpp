@@ -105,9 +105,11 @@ namespace visimpl
   }
 
 
-  void SubsetImporter::reload( const simil::SubsetEventManager* subsetEventMngr )
+  void SubsetImporter::reload( const simil::SubsetEventManager* subsetEventMngr,
+                               TSubsetIndexPtr subsetIndex )
   {
     _subsetEventManager = subsetEventMngr;
+    _subsetIndex = subsetIndex;
 
     if( !_subsetEventManager )
       return;
@@ -117,23 +119,33 @@ namespace visimpl
     for( auto subsetName : _subsetEventManager->subsetNames( ))
     {
       auto subset = _subsetEventManager->getSubset( subsetName );
+      _addLine( subsetName, subset.size( ));
+    }
 
-      QWidget* container = new QWidget( );
-      QGridLayout* layout = new QGridLayout( );
-      QCheckBox* checkBox = new QCheckBox( subsetName.c_str( ));
-      QLabel* label = new QLabel( QString::number( subset.size( )));
+    if( _subsetIndex )
+    {
+      for( uint64_t i = 0; i < _subsetIndex->subsetsNumber( ); ++i )
+        _addLine( _subsetIndex->subsetName( i ), _subsetIndex->subsetSize( i ));
+    }
+  }
 
-      auto row = std::make_tuple( container, layout, checkBox, label );
-      _subsets.insert( std::make_pair( subsetName, row ));
+  void SubsetImporter::_addLine( const std::string& name, uint64_t size )
+  {
+    QWidget* container = new QWidget( );
+    QGridLayout* layout = new QGridLayout( );
+    QCheckBox* checkBox = new QCheckBox( name.c_str( ));
+    QLabel* label = new QLabel( QString::number( size ));
 
-      checkBox->setChecked( true );
+    auto row = std::make_tuple( container, layout, checkBox, label );
+    _subsets.insert( std::make_pair( name, row ));
 
-      container->setLayout( layout );
-      layout->addWidget( checkBox, 0, 0, 1, 2 );
-      layout->addWidget( label, 0, 2, 1, 1 );
+    checkBox->setChecked( true );
 
-      _layoutSubsets->addWidget( container );
-    }
+    container->setLayout( layout );
+    layout->addWidget( checkBox, 0, 0, 1, 2 );
+    layout->addWidget( label, 0, 2, 1, 1 );
+
+    _layoutSubsets->addWidget( container );
   }
 
   void SubsetImporter::clear( void )
@@ -30,6 +30,7 @@
 #include <QVBoxLayout>
 
 #include <simil/simil.h>
+#include <sumrice/sumrice.h>
 
 namespace visimpl
 {
@@ -46,7 +47,8 @@ namespace visimpl
 
     void init( void );
 
-    void reload( const simil::SubsetEventManager* );
+    void reload( const simil::SubsetEventManager*,
+                 TSubsetIndexPtr subsetIndex = nullptr );
     void clear( void );
 
     const std::vector< std::string > selectedSubsets( void ) const;
@@ -63,6 +65,7 @@ namespace visimpl
   protected:
 
     const simil::SubsetEventManager* _subsetEventManager;
+    TSubsetIndexPtr _subsetIndex;
 
     enum TSubsetLine { sl_container = 0, sl_layout, sl_checkbox, sl_label };
     typedef std::tuple< QWidget*, QGridLayout*, QCheckBox*, QLabel* > tSubsetLine;
@@ -72,6 +75,8 @@ namespace visimpl
 
     QVBoxLayout* _layoutSubsets;
 
+    void _addLine( const std::string& name, uint64_t size );
+
     std::map< std::string, tSubsetLine > _subsets;
 
   };
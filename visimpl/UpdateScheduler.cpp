@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "UpdateScheduler.h"
+
+#include <algorithm>
+
+namespace visimpl
+{
+
+  UpdateScheduler::UpdateScheduler( unsigned int threads )
+  : _task( nullptr )
+  , _batch( 0 )
+  , _busy( 0 )
+  , _exit( false )
+  {
+    _start( threads );
+  }
+
+  UpdateScheduler::~UpdateScheduler( void )
+  {
+    _stop( );
+  }
+
+  void UpdateScheduler::threads( unsigned int threads )
+  {
+    _stop( );
+    _start( threads );
+  }
+
+  unsigned int UpdateScheduler::threads( void ) const
+  {
+    return _queues.size( );
+  }
+
+  void UpdateScheduler::run( size_t tasks, const TTask& task )
+  {
+    if( tasks == 0 )
+      return;
+
+    if( _threads.empty( ) || tasks == 1 )
+    {
+      for( size_t i = 0; i < tasks; ++i )
+        task( i, 0 );
+      return;
+    }
+
+    const size_t workers = _queues.size( );
+    for( size_t i = 0; i < workers; ++i )
+    {
+      std::lock_guard< std::mutex > lock( _queues[ i ].mutex );
+      _queues[ i ].begin = tasks * i / workers;
+      _queues[ i ].end = tasks * ( i + 1 ) / workers;
+    }
+
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      _task = &task;
+      _busy = _threads.size( );
+      ++_batch;
+    }
+    _wake.notify_all( );
+
+    _execute( 0 );
+
+    std::unique_lock< std::mutex > lock( _mutex );
+    _done.wait( lock, [ this ]( ){ return _busy == 0; });
+    _task = nullptr;
+  }
+
+  void UpdateScheduler::_start( unsigned int threads )
+  {
+    if( threads == 0 )
+      threads = std::max( std::thread::hardware_concurrency( ), 1u );
+
+    std::vector< WorkerQueue >( threads ).swap( _queues );
+    for( auto& queue : _queues )
+      queue.begin = queue.end = 0;
+
+    _exit = false;
+    _threads.reserve( threads - 1 );
+    for( unsigned int i = 1; i < threads; ++i )
+      _threads.emplace_back( &UpdateScheduler::_worker, this, i, _batch );
+  }
+
+  void UpdateScheduler::_stop( void )
+  {
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      _exit = true;
+    }
+    _wake.notify_all( );
+
+    for( auto& thread : _threads )
+      thread.join( );
+    _threads.clear( );
+  }
+
+  void UpdateScheduler::_worker( unsigned int worker, uint64_t batch )
+  {
+    while( true )
+    {
+      {
+        std::unique_lock< std::mutex > lock( _mutex );
+        _wake.wait( lock, [ & ]( ){ return _exit || _batch != batch; });
+
+        if( _exit )
+          return;
+
+        batch = _batch;
+      }
+
+      _execute( worker );
+
+      std::lock_guard< std::mutex > lock( _mutex );
+      if( --_busy == 0 )
+        _done.notify_one( );
+    }
+  }
+
+  void UpdateScheduler::_execute( unsigned int worker )
+  {
+    const TTask& task = *_task;
+
+    size_t current;
+    while( _pop( worker, current ) || _steal( worker, current ))
+      task( current, worker );
+  }
+
+  bool UpdateScheduler::_pop( unsigned int worker, size_t& task )
+  {
+    WorkerQueue& queue = _queues[ worker ];
+    std::lock_guard< std::mutex > lock( queue.mutex );
+
+    if( queue.begin == queue.end )
+      return false;
+
+    task = queue.begin++;
+    return true;
+  }
+
+  bool UpdateScheduler::_steal( unsigned int worker, size_t& task )
+  {
+    const unsigned int workers = _queues.size( );
+
+    for( unsigned int i = 1; i < workers; ++i )
+    {
+      WorkerQueue& victim = _queues[( worker + i ) % workers ];
+
+      size_t begin, end;
+      {
+        std::lock_guard< std::mutex > lock( victim.mutex );
+        if( victim.begin == victim.end )
+          continue;
+
+        // Taking the back half leaves the victim its next tasks.
+        begin = victim.begin + ( victim.end - victim.begin ) / 2;
+        end = victim.end;
+        victim.end = begin;
+      }
+
+      WorkerQueue& queue = _queues[ worker ];
+      std::lock_guard< std::mutex > lock( queue.mutex );
+      queue.begin = begin + 1;
+      queue.end = end;
+
+      task = begin;
+      return true;
+    }
+
+    return false;
+  }
+
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_UPDATESCHEDULER__
+#define __VISIMPL_UPDATESCHEDULER__
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace visimpl
+{
+  /*
+   * Persistent thread pool running batches of independent tasks, such as
+   * particle update chunks. Every batch is split into contiguous blocks of
+   * task indices, one per worker, so each one walks consecutive chunks.
+   * Workers that run out of tasks steal half of the remaining block of
+   * another worker, keeping the load balanced when some tasks are much
+   * more expensive or one cluster holds most of the particles. The calling
+   * thread works as worker 0 and run( ) returns once every task is done.
+   */
+  class UpdateScheduler
+  {
+  public:
+
+    typedef std::function< void( size_t task, unsigned int worker ) > TTask;
+
+    // 0 threads uses every hardware thread.
+    UpdateScheduler( unsigned int threads = 0 );
+    ~UpdateScheduler( void );
+
+    // Workers including the calling thread.
+    void threads( unsigned int threads );
+    unsigned int threads( void ) const;
+
+    void run( size_t tasks, const TTask& task );
+
+  protected:
+
+    // Remaining [ begin, end ) task indices of a worker. The owner takes
+    // from the front, thieves from the back. Queues of different workers
+    // are kept in different cache lines.
+    struct alignas( 64 ) WorkerQueue
+    {
+      std::mutex mutex;
+      size_t begin;
+      size_t end;
+    };
+
+    void _start( unsigned int threads );
+    void _stop( void );
+
+    // Batches after the given one are run by the worker.
+    void _worker( unsigned int worker, uint64_t batch );
+    void _execute( unsigned int worker );
+
+    bool _pop( unsigned int worker, size_t& task );
+    bool _steal( unsigned int worker, size_t& task );
+
+    std::vector< std::thread > _threads;
+    std::vector< WorkerQueue > _queues;
+
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+
+    const TTask* _task;
+    uint64_t _batch;
+    unsigned int _busy;
+    bool _exit;
+  };
+
+}
+
+#endif /* __VISIMPL_UPDATESCHEDULER__ */
@@ -22,6 +22,8 @@
 
 #include "VisualGroup.h"
 
+#include "prefr/ColorOperationModel.h"
+
 namespace visimpl
 {
 
@@ -206,6 +208,8 @@ namespace visimpl
      _color = colors[ 0 ].second;
      _model->color = gcolors;
 
+     _bakeModel( );
+
    }
 
   TTransferFunction VisualGroup::colorMapping( void ) const
@@ -237,6 +241,8 @@ namespace visimpl
      }
      _model->size = newSize;
 
+     _bakeModel( );
+
    }
 
    TSizeFunction VisualGroup::sizeFunction( void ) const
@@ -252,7 +258,11 @@ namespace visimpl
      return result;
    }
 
-}
-
-
+   void VisualGroup::_bakeModel( void )
+   {
+     auto model = dynamic_cast< prefr::ColorOperationModel* >( _model );
+     if( model )
+       model->bake( );
+   }
 
+}
@@ -79,6 +79,9 @@ namespace visimpl
 
   protected:
 
+    // Transfer function tables follow color and size changes.
+    void _bakeModel( void );
+
     unsigned int _idx;
     static unsigned int _counter;
 
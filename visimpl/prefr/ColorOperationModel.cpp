@@ -22,6 +22,9 @@
 
 #include "ColorOperationModel.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace prefr
 {
 
@@ -40,6 +43,10 @@ namespace prefr
   ColorOperationModel::ColorOperationModel( float min, float max,
                                             ColorOperation colorOp)
   : Model( min, max )
+  , _lutSize( DEFAULT_LUT_SIZE )
+  , _colorError( 0.0f )
+  , _sizeError( 0.0f )
+  , _version( 0 )
   {
     setColorOperation(colorOp);
   }
@@ -65,4 +72,106 @@ namespace prefr
         break;
     }
   }
+
+  void ColorOperationModel::bake( unsigned int lutSize )
+  {
+    _lutSize = lutSize;
+
+    bake( );
+  }
+
+  void ColorOperationModel::bake( void )
+  {
+    ++_version;
+
+    _colorLUT.clear( );
+    _sizeLUT.clear( );
+
+    _bakedColorTimes = color.times;
+    _bakedColorValues = color.values;
+    _bakedSizeTimes = size.times;
+    _bakedSizeValues = size.values;
+
+    _colorError = 0.0f;
+    _sizeError = 0.0f;
+
+    if( _lutSize < 2 || color.times.empty( ) || size.times.empty( ))
+      return;
+
+    _colorLUT.resize( _lutSize );
+    _sizeLUT.resize( _lutSize );
+
+    const float step = 1.0f / ( _lutSize - 1 );
+
+    for( unsigned int i = 0; i < _lutSize; ++i )
+    {
+      _colorLUT[ i ] = color.GetValue( i * step );
+      _sizeLUT[ i ] = size.GetValue( i * step );
+    }
+
+    // Nearest entry lookups are furthest from the curve halfway between
+    // entries.
+    const float scale = lutScale( );
+    for( unsigned int i = 0; i + 1 < _lutSize; ++i )
+    {
+      float refLife = ( i + 0.5f ) * step;
+      unsigned int entry = refLife * scale + 0.5f;
+
+      glm::vec4 colorDiff =
+          glm::abs( color.GetValue( refLife ) - _colorLUT[ entry ]);
+      _colorError = std::max( _colorError,
+          std::max( std::max( colorDiff.r, colorDiff.g ),
+                    std::max( colorDiff.b, colorDiff.a )));
+
+      _sizeError = std::max( _sizeError,
+          std::abs( size.GetValue( refLife ) - _sizeLUT[ entry ]));
+    }
+  }
+
+  bool ColorOperationModel::baked( void ) const
+  {
+    return !_colorLUT.empty( ) && !modified( );
+  }
+
+  bool ColorOperationModel::modified( void ) const
+  {
+    return _bakedColorTimes != color.times ||
+        _bakedColorValues != color.values ||
+        _bakedSizeTimes != size.times || _bakedSizeValues != size.values;
+  }
+
+  unsigned int ColorOperationModel::version( void ) const
+  {
+    return _version;
+  }
+
+  unsigned int ColorOperationModel::lutSize( void ) const
+  {
+    return _lutSize;
+  }
+
+  const glm::vec4* ColorOperationModel::colorLUT( void ) const
+  {
+    return _colorLUT.data( );
+  }
+
+  const float* ColorOperationModel::sizeLUT( void ) const
+  {
+    return _sizeLUT.data( );
+  }
+
+  float ColorOperationModel::lutScale( void ) const
+  {
+    return _colorLUT.empty( ) ? 0.0f : _colorLUT.size( ) - 1;
+  }
+
+  float ColorOperationModel::colorError( void ) const
+  {
+    return _colorError;
+  }
+
+  float ColorOperationModel::sizeError( void ) const
+  {
+    return _sizeError;
+  }
 }
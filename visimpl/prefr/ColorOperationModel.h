@@ -23,6 +23,8 @@
 #ifndef __VISIMPL__COLOROPERATIONMODEL__
 #define __VISIMPL__COLOROPERATIONMODEL__
 
+#include <vector>
+
 #include <prefr/prefr.h>
 
 namespace prefr
@@ -47,10 +49,55 @@ namespace prefr
 
     void setColorOperation( ColorOperation colorOp );
 
+    static const unsigned int DEFAULT_LUT_SIZE = 1024;
+
+    // Samples color and size transfer functions into tables of the given
+    // number of entries, 0 disables the tables. The overload without size
+    // keeps the current one and must be called after changing color or
+    // size.
+    void bake( unsigned int lutSize );
+    void bake( void );
+
+    // Whether the tables match the current control points.
+    bool baked( void ) const;
+
+    // Whether color or size changed since the last bake, with or without
+    // tables.
+    bool modified( void ) const;
+
+    // Increased on every bake, to detect transfer function changes.
+    unsigned int version( void ) const;
+
+    unsigned int lutSize( void ) const;
+
+    // Tables are indexed by the rounded reference life times lutScale( ).
+    const glm::vec4* colorLUT( void ) const;
+    const float* sizeLUT( void ) const;
+    float lutScale( void ) const;
+
+    // Largest difference of the tables against the exact curves, sampled
+    // halfway between entries.
+    float colorError( void ) const;
+    float sizeError( void ) const;
+
   protected:
 
     ColorOperation _colorOperation;
 
+    unsigned int _lutSize;
+    std::vector< glm::vec4 > _colorLUT;
+    std::vector< float > _sizeLUT;
+
+    decltype( color.times ) _bakedColorTimes;
+    decltype( color.values ) _bakedColorValues;
+    decltype( size.times ) _bakedSizeTimes;
+    decltype( size.values ) _bakedSizeValues;
+
+    float _colorError;
+    float _sizeError;
+
+    unsigned int _version;
+
   };
 
 
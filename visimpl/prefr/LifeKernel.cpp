@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "LifeKernel.h"
+
+#include <algorithm>
+
+#if defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 )
+#define VISIMPL_LIFEKERNEL_X86
+#include <immintrin.h>
+#endif
+
+#if defined( VISIMPL_LIFEKERNEL_X86 ) && ( defined( __GNUC__ ) || defined( __clang__ ))
+#define VISIMPL_LIFEKERNEL_AVX2
+#define VISIMPL_TARGET_AVX2 __attribute__(( target( "avx2" )))
+#endif
+
+namespace visimpl
+{
+  namespace kernels
+  {
+    void decayScalar( float* lives, float* refLives, size_t count,
+                      float deltaTime, float invMaxLife )
+    {
+      for( size_t i = 0; i < count; ++i )
+      {
+        float life = std::max( 0.0f, lives[ i ] - deltaTime );
+        lives[ i ] = life;
+        refLives[ i ] = 1.0f - std::min( life * invMaxLife, 1.0f );
+      }
+    }
+
+#ifdef VISIMPL_LIFEKERNEL_X86
+
+    // Lives are never negative after the decay, so only the upper clamp
+    // is needed for the reference life.
+    static void decaySSE( float* lives, float* refLives, size_t count,
+                          float deltaTime, float invMaxLife )
+    {
+      const __m128 zero = _mm_setzero_ps( );
+      const __m128 one = _mm_set1_ps( 1.0f );
+      const __m128 delta = _mm_set1_ps( deltaTime );
+      const __m128 invMax = _mm_set1_ps( invMaxLife );
+
+      size_t i = 0;
+      for( ; i + 8 <= count; i += 8 )
+      {
+        __m128 lifeA = _mm_loadu_ps( lives + i );
+        __m128 lifeB = _mm_loadu_ps( lives + i + 4 );
+
+        lifeA = _mm_max_ps( zero, _mm_sub_ps( lifeA, delta ));
+        lifeB = _mm_max_ps( zero, _mm_sub_ps( lifeB, delta ));
+
+        _mm_storeu_ps( lives + i, lifeA );
+        _mm_storeu_ps( lives + i + 4, lifeB );
+
+        _mm_storeu_ps( refLives + i,
+            _mm_sub_ps( one, _mm_min_ps( _mm_mul_ps( lifeA, invMax ), one )));
+        _mm_storeu_ps( refLives + i + 4,
+            _mm_sub_ps( one, _mm_min_ps( _mm_mul_ps( lifeB, invMax ), one )));
+      }
+
+      decayScalar( lives + i, refLives + i, count - i, deltaTime, invMaxLife );
+    }
+
+#endif
+
+#ifdef VISIMPL_LIFEKERNEL_AVX2
+
+    VISIMPL_TARGET_AVX2
+    static void decayAVX2( float* lives, float* refLives, size_t count,
+                           float deltaTime, float invMaxLife )
+    {
+      const __m256 zero = _mm256_setzero_ps( );
+      const __m256 one = _mm256_set1_ps( 1.0f );
+      const __m256 delta = _mm256_set1_ps( deltaTime );
+      const __m256 invMax = _mm256_set1_ps( invMaxLife );
+
+      size_t i = 0;
+      for( ; i + 16 <= count; i += 16 )
+      {
+        __m256 lifeA = _mm256_loadu_ps( lives + i );
+        __m256 lifeB = _mm256_loadu_ps( lives + i + 8 );
+
+        lifeA = _mm256_max_ps( zero, _mm256_sub_ps( lifeA, delta ));
+        lifeB = _mm256_max_ps( zero, _mm256_sub_ps( lifeB, delta ));
+
+        _mm256_storeu_ps( lives + i, lifeA );
+        _mm256_storeu_ps( lives + i + 8, lifeB );
+
+        _mm256_storeu_ps( refLives + i, _mm256_sub_ps( one,
+            _mm256_min_ps( _mm256_mul_ps( lifeA, invMax ), one )));
+        _mm256_storeu_ps( refLives + i + 8, _mm256_sub_ps( one,
+            _mm256_min_ps( _mm256_mul_ps( lifeB, invMax ), one )));
+      }
+
+      decayScalar( lives + i, refLives + i, count - i, deltaTime, invMaxLife );
+    }
+
+#endif
+
+    struct DecayDispatch
+    {
+      TDecayKernel kernel;
+      const char* isa;
+    };
+
+    static DecayDispatch selectDecay( void )
+    {
+#ifdef VISIMPL_LIFEKERNEL_AVX2
+      __builtin_cpu_init( );
+      if( __builtin_cpu_supports( "avx2" ))
+        return { decayAVX2, "avx2" };
+#endif
+#ifdef VISIMPL_LIFEKERNEL_X86
+      return { decaySSE, "sse" };
+#else
+      return { decayScalar, "scalar" };
+#endif
+    }
+
+    static const DecayDispatch& decayDispatch( void )
+    {
+      static const DecayDispatch dispatch = selectDecay( );
+      return dispatch;
+    }
+
+    void decay( float* lives, float* refLives, size_t count,
+                float deltaTime, float invMaxLife )
+    {
+      decayDispatch( ).kernel( lives, refLives, count, deltaTime, invMaxLife );
+    }
+
+    const char* decayISA( void )
+    {
+      return decayDispatch( ).isa;
+    }
+  }
+}
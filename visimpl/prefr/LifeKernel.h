@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2015-2020 GMRV/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/gmrvvis/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_LIFEKERNEL__
+#define __VISIMPL_LIFEKERNEL__
+
+#include <cstddef>
+
+namespace visimpl
+{
+  /*
+   * Particle life decay over contiguous life columns: every life loses
+   * deltaTime, clamped at zero, and its reference life
+   * 1 - clamp( life * invMaxLife, 0, 1 ) is stored for the transfer
+   * functions. The SSE or AVX2 version is chosen once at runtime from the
+   * CPU features, other architectures use the scalar version.
+   */
+  namespace kernels
+  {
+    typedef void ( *TDecayKernel )( float* lives, float* refLives,
+                                    size_t count, float deltaTime,
+                                    float invMaxLife );
+
+    void decay( float* lives, float* refLives, size_t count,
+                float deltaTime, float invMaxLife );
+
+    void decayScalar( float* lives, float* refLives, size_t count,
+                      float deltaTime, float invMaxLife );
+
+    // Instruction set of the dispatched decay kernel.
+    const char* decayISA( void );
+  }
+}
+
+#endif /* __VISIMPL_LIFEKERNEL__ */
@@ -27,20 +27,14 @@ namespace visimpl
   SourceMultiPosition::SourceMultiPosition( void )
   : Source( -1, glm::vec3( 0, 0, 0))
   , _positions( nullptr )
-  , _idxTranslate( nullptr )
   { }
 
   SourceMultiPosition::~SourceMultiPosition( void )
   { }
 
-  void SourceMultiPosition::setIdxTranslation( const tUintUMap& idxTranslation )
+  void SourceMultiPosition::setPositions( const TParticlePositions* positions )
   {
-    _idxTranslate = &idxTranslation;
-  }
-
-  void SourceMultiPosition::setPositions( const tGidPosMap& positions_ )
-  {
-    _positions = &positions_;
+    _positions = positions;
   }
 
   void SourceMultiPosition::removeElements( const prefr::ParticleSet& indices )
@@ -48,18 +42,4 @@ namespace visimpl
     _particles.removeIndices( indices );
     restart( );
   }
-
-  vec3 SourceMultiPosition::position( unsigned int idx )
-  {
-    assert( !_idxTranslate->empty( ));
-    assert( !_positions->empty( ) );
-
-    auto partId = _idxTranslate->find( idx );
-    assert( partId != _idxTranslate->end( ));
-
-    auto pos = _positions->find( partId->second );
-    assert( pos != _positions->end( ));
-
-    return pos->second;
-  }
 }
@@ -26,8 +26,14 @@
 #include "../types.h"
 #include <prefr/prefr.h>
 
+#include <cassert>
+#include <vector>
+
 namespace visimpl
 {
+  // Particle positions indexed by particle id.
+  typedef std::vector< vec3 > TParticlePositions;
+
   class SourceMultiPosition : public prefr::Source
   {
   public:
@@ -35,17 +41,21 @@ namespace visimpl
     SourceMultiPosition( void );
     ~SourceMultiPosition( void );
 
-    void setIdxTranslation( const tUintUMap& idxTranslation );
-    void setPositions( const tGidPosMap& positions );
+    // Positions are owned and kept up to date by the domain manager.
+    void setPositions( const TParticlePositions* positions );
 
     void removeElements( const prefr::ParticleSet& indices );
 
-    vec3 position( unsigned int idx );
+    inline const vec3& position( unsigned int idx ) const
+    {
+      assert( _positions && idx < _positions->size( ));
+
+      return ( *_positions )[ idx ];
+    }
 
   protected:
 
-    const tGidPosMap* _positions;
-    const tUintUMap* _idxTranslate;
+    const TParticlePositions* _positions;
   };
 
 
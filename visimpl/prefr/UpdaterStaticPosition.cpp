@@ -23,6 +23,10 @@
 #include "UpdaterStaticPosition.h"
 
 #include "SourceMultiPosition.h"
+#include "LifeKernel.h"
+#include "ColorOperationModel.h"
+
+#include <vector>
 
 namespace visimpl
 {
@@ -30,6 +34,7 @@ namespace visimpl
 
   UpdaterStaticPosition::UpdaterStaticPosition( void )
   : prefr::Updater( )
+  , _batched( false )
   { }
 
   UpdaterStaticPosition::~UpdaterStaticPosition( void )
@@ -40,6 +45,8 @@ namespace visimpl
   void UpdaterStaticPosition::updateParticle( prefr::tparticle current,
                                               float deltaTime )
     {
+      if( _batched )
+        return;
 
       unsigned int id = current.id( );
       SourceMultiPosition* source =
@@ -52,19 +59,7 @@ namespace visimpl
 
 
       if( _updateConfig->emitted( id ) && !current.alive( ))
-      {
-        current.set_life( 0 );
-
-        current.set_alive( true );
-
-        current.set_position( source->position( id ));
-        current.set_velocity( glm::vec3( 0, 1, 0 ) );
-
-        current.set_velocityModule( 0 );
-        current.set_acceleration( glm::vec3( 0, 0, 0 ));
-
-        _updateConfig->setEmitted( id, false );
-      }
+        _emit( current, source );
 
       float life = std::max( 0.0f, current.life( ) - deltaTime );
 
@@ -88,6 +83,136 @@ namespace visimpl
 
     }
 
-}
+  void UpdaterStaticPosition::updateParticles(
+      prefr::Cluster& cluster, prefr::ParticleCollection& particles,
+      const uint32_t* ids, size_t count, float deltaTime,
+      std::vector< uint32_t >& alive, std::vector< uint32_t >& emit )
+  {
+    Model* model = cluster.model( );
+    assert( model );
+
+    const float invMaxLife = model->inverseMaxLife( );
+    auto& color = model->color;
+    auto& size = model->size;
+
+    // Lives are gathered into contiguous columns for the decay kernel.
+    // Buffers are kept per thread, so particles can be updated
+    // concurrently without allocating every frame.
+    static thread_local std::vector< float > lives;
+    static thread_local std::vector< float > refLives;
+
+    lives.resize( count );
+    refLives.resize( count );
+
+    for( size_t i = 0; i < count; ++i )
+    {
+      unsigned int id = ids[ i ];
+      auto current = particles.at( id );
+
+      // Emitted particles start with no life. Their alive and emission
+      // flags may be bit packed, so they are only written by
+      // emitParticles( ).
+      if( !current.alive( ) && _updateConfig->emitted( id ))
+      {
+        emit.push_back( id );
+        lives[ i ] = 0.0f;
+      }
+      else
+        lives[ i ] = current.life( );
+    }
+
+    kernels::decay( lives.data( ), refLives.data( ), count, deltaTime,
+                    invMaxLife );
+
+    // Baked tables replace the control point search, models changed
+    // without baking again keep using the exact curves.
+    auto lutModel = dynamic_cast< ColorOperationModel* >( model );
+    if( lutModel && lutModel->baked( ))
+    {
+      const glm::vec4* colorLUT = lutModel->colorLUT( );
+      const float* sizeLUT = lutModel->sizeLUT( );
+      const float scale = lutModel->lutScale( );
+
+      for( size_t i = 0; i < count; ++i )
+      {
+        unsigned int id = ids[ i ];
+        auto current = particles.at( id );
+        unsigned int entry = refLives[ i ] * scale + 0.5f;
+
+        current.set_life( lives[ i ]);
+        current.set_color( colorLUT[ entry ]);
+        current.set_size( sizeLUT[ entry ]);
+
+        if( lives[ i ] > 0.0f )
+          alive.push_back( id );
+      }
+
+      return;
+    }
+
+    for( size_t i = 0; i < count; ++i )
+    {
+      unsigned int id = ids[ i ];
+      auto current = particles.at( id );
 
+      current.set_life( lives[ i ]);
+      current.set_color( color.GetValue( refLives[ i ]));
+      current.set_size( size.GetValue( refLives[ i ]));
 
+      if( lives[ i ] > 0.0f )
+        alive.push_back( id );
+    }
+  }
+
+  void UpdaterStaticPosition::emitParticles(
+      prefr::ParticleCollection& particles,
+      const std::vector< uint32_t >& ids )
+  {
+    // Consecutive particles mostly share their source.
+    Source* lastSource = nullptr;
+    SourceMultiPosition* source = nullptr;
+
+    for( auto id : ids )
+    {
+      Source* particleSource = _updateConfig->source( id );
+      if( particleSource != lastSource )
+      {
+        lastSource = particleSource;
+        source = dynamic_cast< SourceMultiPosition* >( particleSource );
+      }
+
+      assert( source );
+
+      _emit( particles.at( id ), source );
+    }
+  }
+
+  void UpdaterStaticPosition::_emit( prefr::tparticle current,
+                                     SourceMultiPosition* source )
+  {
+    unsigned int id = current.id( );
+
+    current.set_life( 0 );
+
+    current.set_alive( true );
+
+    current.set_position( source->position( id ));
+    current.set_velocity( glm::vec3( 0, 1, 0 ) );
+
+    current.set_velocityModule( 0 );
+    current.set_acceleration( glm::vec3( 0, 0, 0 ));
+
+    _updateConfig->setEmitted( id, false );
+  }
+
+  void UpdaterStaticPosition::batched( bool state )
+  {
+    _batched = state;
+  }
+
+  bool UpdaterStaticPosition::batched( void ) const
+  {
+    return _batched;
+  }
+
+}
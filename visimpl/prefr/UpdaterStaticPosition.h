@@ -27,8 +27,12 @@
 
 #include <prefr/prefr.h>
 
+#include <vector>
+
 namespace visimpl
 {
+  class SourceMultiPosition;
+
   class UpdaterStaticPosition : public prefr::Updater
   {
   public:
@@ -38,6 +42,31 @@ namespace visimpl
 
     void updateParticle( prefr::tparticle current, float deltaTime );
 
+    // Updates the given particles with the cluster model, resolving it and
+    // its transfer functions once instead of per particle. Particles left
+    // with life are appended to alive. Only the given particles are
+    // written, so disjoint sets can be updated concurrently: particles due
+    // to be emitted are updated as just emitted and appended to emit, to be
+    // passed to emitParticles( ) afterwards.
+    void updateParticles( prefr::Cluster& cluster,
+                          prefr::ParticleCollection& particles,
+                          const uint32_t* ids, size_t count, float deltaTime,
+                          std::vector< uint32_t >& alive,
+                          std::vector< uint32_t >& emit );
+
+    void emitParticles( prefr::ParticleCollection& particles,
+                        const std::vector< uint32_t >& ids );
+
+    // When batched, per particle calls from prefr do nothing and clusters
+    // must be updated through updateParticles( ).
+    void batched( bool state );
+    bool batched( void ) const;
+
+  protected:
+
+    void _emit( prefr::tparticle current, SourceMultiPosition* source );
+
+    bool _batched;
 
   };
 
@@ -62,6 +62,14 @@ int main( int argc, char** argv )
   std::string report = std::string( "" );
   std::string subsetEventFile( "" );
   std::string scaleFactor("");
+  size_t spikeMemoryBudget = 0;
+  long long keyframeMemoryBudget = -1;
+  int simulationThreadDepth = -1;
+  float simulationThreadLead = 0.0f;
+  float frameBudget = -1.0f;
+  int lutSize = -1;
+  int updateThreads = -1;
+  std::string traceFile( "" );
 
   bool fullscreen = false, initWindowSize = false, initWindowMaximized = false;
   int initWindowWidth, initWindowHeight;
@@ -176,6 +184,74 @@ int main( int argc, char** argv )
         usageMessage( argv[0] );
     }
 
+    if( std::strcmp( argv[ i ], "-membudget" ) == 0 )
+    {
+      if(++i < argc )
+      {
+        spikeMemoryBudget = std::strtoull( argv[ i ], nullptr, 10 ) << 20;
+      }
+      else
+        usageMessage( argv[0] );
+    }
+
+    if( std::strcmp( argv[ i ], "-keyframebudget" ) == 0 )
+    {
+      if(++i < argc )
+      {
+        keyframeMemoryBudget = std::strtoll( argv[ i ], nullptr, 10 ) << 20;
+      }
+      else
+        usageMessage( argv[0] );
+    }
+
+    if( std::strcmp( argv[ i ], "-simthread" ) == 0 )
+    {
+      if( i + 2 >= argc )
+        usageMessage( argv[0] );
+      simulationThreadDepth = atoi( argv[ ++i ] );
+      simulationThreadLead = atof( argv[ ++i ] );
+    }
+
+    if( std::strcmp( argv[ i ], "-framebudget" ) == 0 )
+    {
+      if(++i < argc )
+      {
+        frameBudget = std::atof( argv[ i ]);
+      }
+      else
+        usageMessage( argv[0] );
+    }
+
+    if( std::strcmp( argv[ i ], "-lut" ) == 0 )
+    {
+      if(++i < argc )
+      {
+        lutSize = std::atoi( argv[ i ]);
+      }
+      else
+        usageMessage( argv[0] );
+    }
+
+    if( std::strcmp( argv[ i ], "-threads" ) == 0 )
+    {
+      if(++i < argc )
+      {
+        updateThreads = std::atoi( argv[ i ]);
+      }
+      else
+        usageMessage( argv[0] );
+    }
+
+    if( std::strcmp( argv[ i ], "-trace" ) == 0 )
+    {
+      if(++i < argc )
+      {
+        traceFile = argv[ i ];
+      }
+      else
+        usageMessage( argv[0] );
+    }
+
     if( std::strcmp( argv[ i ], "-spikes" ) == 0 )
     {
       simType = simil::TSimSpikes;
@@ -213,8 +289,8 @@ int main( int argc, char** argv )
     }
   }
 
-
-
+  if( !traceFile.empty( ))
+    visimpl::PhaseTracer::instance( ).enable( traceFile );
 
   setFormat( );
   visimpl::MainWindow mainWindow;
@@ -249,6 +325,24 @@ int main( int argc, char** argv )
     }
   }
 
+  if( spikeMemoryBudget > 0 )
+    mainWindow.spikeMemoryBudget( spikeMemoryBudget );
+
+  if( keyframeMemoryBudget >= 0 )
+    mainWindow.keyframeMemoryBudget( keyframeMemoryBudget );
+
+  if( simulationThreadDepth >= 0 )
+    mainWindow.simulationThread( simulationThreadDepth, simulationThreadLead );
+
+  if( frameBudget >= 0.0f )
+    mainWindow.frameBudget( frameBudget );
+
+  if( lutSize >= 0 )
+    mainWindow.lutSize( lutSize );
+
+  if( updateThreads >= 0 )
+    mainWindow.updateThreads( updateThreads );
+
   if( !networkFile.empty( ))
   switch( dataType )
   {
@@ -272,7 +366,12 @@ int main( int argc, char** argv )
       break;
   }
 
-  return application.exec();
+  int result = application.exec( );
+
+  if( !traceFile.empty( ))
+    visimpl::PhaseTracer::instance( ).write( );
+
+  return result;
 
 }
 
@@ -294,6 +393,23 @@ void usageMessage( char* progName )
 //            << std::endl
             << "\t[ -scale <X,Y,Z> ]"
             << std::endl
+            << "\t[ -membudget <spike_memory_budget_MB> ]"
+            << std::endl
+            << "\t[ -keyframebudget <activity_keyframes_MB> ]"
+            << std::endl
+            << "\t[ -simthread <ring_frames> <lead_time> ]"
+            << std::endl
+            << "\t    ( each ring frame holds up to 8 bytes per neuron"
+            << " firing in a frame )"
+            << std::endl
+            << "\t[ -framebudget <milliseconds> ]"
+            << std::endl
+            << "\t[ -lut <transfer_function_entries> ]"
+            << std::endl
+            << "\t[ -threads <particle_update_threads> ]"
+            << std::endl
+            << "\t[ -trace <chrome_trace_file.json> ]"
+            << std::endl
             << "\t[ -zeq <session_name*> ]"
             << std::endl
             << "\t[ -ws | --window-size ] <width> <height> ]"
@@ -0,0 +1,168 @@
+/*
+ * @file  KernelBenchmark.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include "KernelBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../visimpl/DomainManager.h"
+#include "../visimpl/prefr/LifeKernel.h"
+
+namespace visimplbench
+{
+  typedef std::chrono::steady_clock TClock;
+
+  static void setLives( prefr::ParticleCollection& particles,
+                        const std::vector< uint32_t >& ids,
+                        const std::vector< float >& lives )
+  {
+    for( size_t i = 0; i < ids.size( ); ++i )
+      particles.at( ids[ i ]).set_life( lives[ i ]);
+  }
+
+  static void getLives( prefr::ParticleCollection& particles,
+                        const std::vector< uint32_t >& ids,
+                        std::vector< float >& lives )
+  {
+    lives.resize( ids.size( ));
+    for( size_t i = 0; i < ids.size( ); ++i )
+      lives[ i ] = particles.at( ids[ i ]).life( );
+  }
+
+  bool benchmarkParticleUpdate( size_t particles, unsigned int iterations )
+  {
+    // Synthetic network updated through the same particle system, clusters
+    // and models as playback, so gathering and scattering particles is
+    // part of the measure.
+    std::mt19937 generator( 0 );
+    std::uniform_real_distribution< float > distribution( -1.0f, 2.0f );
+
+    visimpl::TGIDSet gids;
+    visimpl::TPosVect positions;
+    positions.reserve( particles );
+    for( size_t i = 0; i < particles; ++i )
+    {
+      gids.insert( i );
+      positions.emplace_back( distribution( generator ),
+                              distribution( generator ),
+                              distribution( generator ));
+    }
+
+    auto network = visimpl::NetworkSnapshot::create(
+        gids, positions, visimpl::vec3( 1.0f, 1.0f, 1.0f ));
+
+    prefr::ParticleSystem particleSystem( particles, nullptr );
+    visimpl::DomainManager domainManager( &particleSystem, network );
+
+#ifdef SIMIL_USE_BRION
+    domainManager.init( nullptr );
+#else
+    domainManager.init( );
+#endif
+    domainManager.initializeParticleSystem( false );
+    domainManager.mode( visimpl::TMODE_SELECTION );
+    domainManager.resetParticles( );
+    domainManager.updateParticles( 0.0f );
+
+    // The biggest cluster run by the particle updater.
+    prefr::Cluster* cluster = nullptr;
+    visimpl::UpdaterStaticPosition* updater = nullptr;
+    std::vector< uint32_t > ids;
+    for( auto candidate : particleSystem.clusters( ))
+    {
+      auto candidateUpdater =
+          dynamic_cast< visimpl::UpdaterStaticPosition* >(
+              candidate->updater( ));
+      if( !candidateUpdater )
+        continue;
+
+      std::vector< uint32_t > candidateIds;
+      for( auto particle : candidate->particles( ).indices( ))
+        candidateIds.push_back( particle );
+
+      if( candidateIds.size( ) <= ids.size( ))
+        continue;
+
+      cluster = candidate;
+      updater = candidateUpdater;
+      ids.swap( candidateIds );
+    }
+
+    if( !cluster )
+    {
+      std::cerr << "No particles to update" << std::endl;
+      return false;
+    }
+
+    // Mix of dead, decaying and freshly activated particles.
+    std::vector< float > initial( ids.size( ));
+    for( auto& life : initial )
+      life = std::max( 0.0f, distribution( generator ));
+
+    auto& collection = particleSystem.particles( );
+    const float deltaTime = 0.01f;
+
+    std::vector< float > particleLives, batchLives;
+    std::vector< uint32_t > alive, emit;
+    double particleTime = 0.0;
+    double batchTime = 0.0;
+
+    for( unsigned int i = 0; i < iterations; ++i )
+    {
+      setLives( collection, ids, initial );
+      updater->batched( false );
+
+      auto start = TClock::now( );
+      for( auto id : ids )
+        updater->updateParticle( collection.at( id ), deltaTime );
+      particleTime += std::chrono::duration< double, std::micro >(
+          TClock::now( ) - start ).count( );
+
+      getLives( collection, ids, particleLives );
+
+      setLives( collection, ids, initial );
+      updater->batched( true );
+      alive.clear( );
+      emit.clear( );
+
+      start = TClock::now( );
+      updater->updateParticles( *cluster, collection, ids.data( ), ids.size( ),
+                                deltaTime, alive, emit );
+      batchTime += std::chrono::duration< double, std::micro >(
+          TClock::now( ) - start ).count( );
+
+      getLives( collection, ids, batchLives );
+    }
+
+    particleTime /= std::max( 1u, iterations );
+    batchTime /= std::max( 1u, iterations );
+
+    bool equal = particleLives == batchLives;
+
+    std::cout << "Particle update over " << ids.size( ) << " particles, "
+              << iterations << " iterations (microseconds per update)"
+              << std::endl
+              << "  per particle: " << particleTime << std::endl
+              << "  batched (" << visimpl::kernels::decayISA( ) << "): "
+              << batchTime << std::endl
+              << "  speedup: "
+              << ( batchTime > 0.0 ? particleTime / batchTime : 0.0 )
+              << "x" << std::endl;
+
+    if( !equal )
+      std::cerr << "Batched lives differ from per particle ones" << std::endl;
+
+    return equal;
+  }
+
+}
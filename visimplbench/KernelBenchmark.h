@@ -0,0 +1,22 @@
+/*
+ * @file  KernelBenchmark.h
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+#ifndef __VISIMPLBENCH_KERNELBENCHMARK__
+#define __VISIMPLBENCH_KERNELBENCHMARK__
+
+#include <cstddef>
+
+namespace visimplbench
+{
+  // Times the batched cluster update against per particle updates over a
+  // particle system of the given size. Returns false if the resulting
+  // lives differ.
+  bool benchmarkParticleUpdate( size_t particles, unsigned int iterations );
+}
+
+#endif /* __VISIMPLBENCH_KERNELBENCHMARK__ */
@@ -0,0 +1,416 @@
+/*
+ * @file  PlaybackBenchmark.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include "PlaybackBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include <QFile>
+#include <QJsonDocument>
+
+namespace visimplbench
+{
+  typedef std::chrono::steady_clock TClock;
+
+  static double elapsedMicroseconds( const TClock::time_point& from,
+                                     const TClock::time_point& to )
+  {
+    return std::chrono::duration< double, std::micro >( to - from ).count( );
+  }
+
+  BenchmarkConfig::BenchmarkConfig( void )
+  : dataType( simil::TCSV )
+  , frames( 1000 )
+  , warmupFrames( 10 )
+  , deltaTime( 0.005f )
+  , updateDelta( 0.005f )
+  , decay( 0.1f )
+  , lutSize( prefr::ColorOperationModel::DEFAULT_LUT_SIZE )
+  , threads( 0 )
+  , groups( 4 )
+  , modes( { visimpl::TMODE_SELECTION, visimpl::TMODE_GROUPS,
+             visimpl::TMODE_ATTRIBUTE } )
+  , tolerance( 0.1f )
+  { }
+
+  PlaybackBenchmark::PlaybackBenchmark( const BenchmarkConfig& config )
+  : _config( config )
+  , _player( nullptr )
+  , _particleSystem( nullptr )
+  , _domainManager( nullptr )
+  { }
+
+  PlaybackBenchmark::~PlaybackBenchmark( void )
+  {
+    delete _domainManager;
+    delete _particleSystem;
+    delete _player;
+  }
+
+  bool PlaybackBenchmark::load( void )
+  {
+    std::cout << "Loading " << _config.networkFile << "..." << std::endl;
+
+    simil::SpikeData* data = visimpl::SpikeCache::load( _config.networkFile,
+                                                        _config.dataType,
+                                                        _config.activityFile );
+    if( !data )
+    {
+      std::cerr << "Could not load " << _config.networkFile << std::endl;
+      return false;
+    }
+
+    _player = new simil::SpikesPlayer( );
+    _player->LoadData( data );
+    _player->deltaTime( _config.deltaTime );
+    _player->loop( true );
+
+    _spikeIndex = std::make_shared< visimpl::SpikeTimeIndex >(
+        data->spikes( ), data->startTime( ), data->endTime( ));
+
+    auto network = visimpl::NetworkSnapshot::create(
+        _player->gids( ), _player->positions( ),
+        visimpl::vec3( 1.0f, 1.0f, 1.0f ));
+
+    unsigned int maxParticles =
+        std::max(( unsigned int ) 100000, ( unsigned int ) _player->gids( ).size( ));
+
+    // No camera nor renderer, particles are only updated.
+    _particleSystem = new prefr::ParticleSystem( maxParticles, nullptr );
+
+    _domainManager = new visimpl::DomainManager( _particleSystem, network );
+
+#ifdef SIMIL_USE_BRION
+    _domainManager->init( data->blueConfig( ));
+#else
+    _domainManager->init( );
+#endif
+    _domainManager->initializeParticleSystem( false );
+    _domainManager->decay( _config.decay );
+    _domainManager->lutSize( _config.lutSize );
+    _domainManager->updateThreads( _config.threads );
+
+    const visimpl::TGIDSet& gids = _player->gids( );
+    unsigned int groups = std::max( 1u, _config.groups );
+    size_t groupSize = ( gids.size( ) + groups - 1 ) / groups;
+
+    auto gid = gids.begin( );
+    for( unsigned int i = 0; i < groups && gid != gids.end( ); ++i )
+    {
+      visimpl::GIDUSet group;
+      for( size_t j = 0; j < groupSize && gid != gids.end( ); ++j, ++gid )
+        group.insert( *gid );
+
+      if( i == 0 )
+        _domainManager->selection( group );
+
+      _domainManager->addVisualGroup( group, "Group " + std::to_string( i ));
+    }
+
+    std::cout << gids.size( ) << " neurons, "
+              << data->spikes( ).size( ) << " spikes from "
+              << data->startTime( ) << " to " << data->endTime( )
+              << std::endl;
+
+    return true;
+  }
+
+  void PlaybackBenchmark::run( void )
+  {
+    _results.clear( );
+
+    for( auto mode : _config.modes )
+      _results.push_back( _runMode( mode ));
+  }
+
+  ModeResult PlaybackBenchmark::_runMode( visimpl::tVisualMode mode )
+  {
+    std::cout << "Running " << modeName( mode ) << " mode..." << std::endl;
+
+    _domainManager->mode( mode );
+    _domainManager->resetParticles( );
+
+    _player->Stop( );
+    _player->Play( );
+
+    std::vector< double > samples[ TSTAGE_NUMBER ];
+    for( auto& stage : samples )
+      stage.reserve( _config.frames );
+
+    uint64_t spikes = 0;
+
+    for( unsigned int i = 0; i < _config.warmupFrames + _config.frames; ++i )
+    {
+      float prevTime = _player->currentTime( );
+
+      auto start = TClock::now( );
+
+      _player->Frame( );
+
+      auto framed = TClock::now( );
+
+      float currentTime = _player->currentTime( );
+      float beginTime = currentTime < prevTime ?
+                        _player->startTime( ) : prevTime;
+
+      auto range = _spikeIndex->spikesBetween( beginTime, currentTime );
+      _domainManager->processInput( range, beginTime, currentTime, false );
+
+      auto processed = TClock::now( );
+
+      _domainManager->updateParticles( _config.updateDelta );
+
+      auto updated = TClock::now( );
+
+      if( i < _config.warmupFrames )
+        continue;
+
+      samples[ TSTAGE_FRAME ].push_back( elapsedMicroseconds( start, framed ));
+      samples[ TSTAGE_INPUT ].push_back(
+          elapsedMicroseconds( framed, processed ));
+      samples[ TSTAGE_UPDATE ].push_back(
+          elapsedMicroseconds( processed, updated ));
+      samples[ TSTAGE_TOTAL ].push_back( elapsedMicroseconds( start, updated ));
+
+      spikes += range.second - range.first;
+    }
+
+    ModeResult result;
+    result.mode = mode;
+    for( unsigned int i = 0; i < TSTAGE_NUMBER; ++i )
+      result.stages[ i ] = _statistics( samples[ i ]);
+    result.spikesPerFrame =
+        _config.frames > 0 ? double( spikes ) / _config.frames : 0.0;
+
+    return result;
+  }
+
+  StageStatistics PlaybackBenchmark::_statistics( std::vector< double >& samples )
+  {
+    StageStatistics result = { 0.0, 0.0, 0.0, 0.0 };
+
+    if( samples.empty( ))
+      return result;
+
+    std::sort( samples.begin( ), samples.end( ));
+
+    // Nearest rank percentiles.
+    auto percentile = [ &samples ]( double p )
+    {
+      size_t rank = std::ceil( p * samples.size( ));
+      return samples[ std::max( rank, ( size_t ) 1 ) - 1 ];
+    };
+
+    double sum = 0.0;
+    for( auto sample : samples )
+      sum += sample;
+
+    result.mean = sum / samples.size( );
+    result.p50 = percentile( 0.50 );
+    result.p95 = percentile( 0.95 );
+    result.p99 = percentile( 0.99 );
+
+    return result;
+  }
+
+  void PlaybackBenchmark::report( void ) const
+  {
+    std::cout << std::endl << _config.frames << " frames, delta time "
+              << _config.deltaTime << ", update delta "
+              << _config.updateDelta << " (microseconds per frame)"
+              << std::endl;
+
+    std::cout << std::fixed << std::setprecision( 1 );
+
+    for( const auto& result : _results )
+    {
+      std::cout << std::endl << modeName( result.mode ) << ": "
+                << result.spikesPerFrame << " spikes per frame" << std::endl;
+
+      std::cout << std::setw( 10 ) << "stage"
+                << std::setw( 12 ) << "mean"
+                << std::setw( 12 ) << "p50"
+                << std::setw( 12 ) << "p95"
+                << std::setw( 12 ) << "p99" << std::endl;
+
+      for( unsigned int i = 0; i < TSTAGE_NUMBER; ++i )
+      {
+        const StageStatistics& stage = result.stages[ i ];
+
+        std::cout << std::setw( 10 ) << stageName( TStage( i ))
+                  << std::setw( 12 ) << stage.mean
+                  << std::setw( 12 ) << stage.p50
+                  << std::setw( 12 ) << stage.p95
+                  << std::setw( 12 ) << stage.p99 << std::endl;
+      }
+    }
+
+    std::cout << std::defaultfloat << std::endl;
+  }
+
+  QJsonObject PlaybackBenchmark::_toJson( void ) const
+  {
+    QJsonObject modes;
+    for( const auto& result : _results )
+    {
+      QJsonObject mode;
+      for( unsigned int i = 0; i < TSTAGE_NUMBER; ++i )
+      {
+        const StageStatistics& stage = result.stages[ i ];
+
+        QJsonObject statistics;
+        statistics[ "mean" ] = stage.mean;
+        statistics[ "p50" ] = stage.p50;
+        statistics[ "p95" ] = stage.p95;
+        statistics[ "p99" ] = stage.p99;
+
+        mode[ stageName( TStage( i ))] = statistics;
+      }
+      mode[ "spikes" ] = result.spikesPerFrame;
+
+      modes[ modeName( result.mode )] = mode;
+    }
+
+    QJsonObject root;
+    root[ "network" ] = QString::fromStdString( _config.networkFile );
+    root[ "activity" ] = QString::fromStdString( _config.activityFile );
+    root[ "frames" ] = int( _config.frames );
+    root[ "delta" ] = _config.deltaTime;
+    root[ "update" ] = _config.updateDelta;
+    root[ "decay" ] = _config.decay;
+    root[ "lut" ] = int( _config.lutSize );
+    root[ "threads" ] = int( _domainManager ?
+                             _domainManager->updateThreads( ) :
+                             _config.threads );
+    root[ "modes" ] = modes;
+
+    return root;
+  }
+
+  bool PlaybackBenchmark::write( void ) const
+  {
+    if( _config.outputFile.empty( ))
+      return true;
+
+    QFile file( QString::fromStdString( _config.outputFile ));
+    if( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ))
+    {
+      std::cerr << "Could not write " << _config.outputFile << std::endl;
+      return false;
+    }
+
+    file.write( QJsonDocument( _toJson( )).toJson( ));
+
+    std::cout << "Results written to " << _config.outputFile << std::endl;
+
+    return true;
+  }
+
+  bool PlaybackBenchmark::compare( void ) const
+  {
+    if( _config.baselineFile.empty( ))
+      return true;
+
+    QFile file( QString::fromStdString( _config.baselineFile ));
+    if( !file.open( QIODevice::ReadOnly ))
+    {
+      std::cerr << "Could not read " << _config.baselineFile << std::endl;
+      return false;
+    }
+
+    QJsonDocument document = QJsonDocument::fromJson( file.readAll( ));
+    if( !document.isObject( ))
+    {
+      std::cerr << "Invalid baseline " << _config.baselineFile << std::endl;
+      return false;
+    }
+
+    QJsonObject baseline = document.object( );
+    if( baseline[ "frames" ].toInt( ) != int( _config.frames ) ||
+        baseline[ "delta" ].toDouble( ) != double( _config.deltaTime ))
+      std::cerr << "Warning: baseline ran with different frames or delta time"
+                << std::endl;
+
+    QJsonObject baselineModes = baseline[ "modes" ].toObject( );
+
+    bool passed = true;
+
+    std::cout << "Comparing p95 against " << _config.baselineFile
+              << " (tolerance " << _config.tolerance * 100.0f << "%)"
+              << std::endl;
+
+    std::cout << std::fixed << std::setprecision( 2 );
+
+    for( const auto& result : _results )
+    {
+      QJsonObject mode = baselineModes[ modeName( result.mode )].toObject( );
+      if( mode.isEmpty( ))
+        continue;
+
+      for( unsigned int i = 0; i < TSTAGE_NUMBER; ++i )
+      {
+        double reference =
+            mode[ stageName( TStage( i ))].toObject( )[ "p95" ].toDouble( );
+        if( reference <= 0.0 )
+          continue;
+
+        double ratio = result.stages[ i ].p95 / reference;
+        bool regressed = ratio > 1.0 + _config.tolerance;
+
+        std::cout << std::setw( 10 ) << modeName( result.mode )
+                  << std::setw( 10 ) << stageName( TStage( i ))
+                  << std::setw( 10 ) << ratio << "x"
+                  << ( regressed ? "  REGRESSION" : "" ) << std::endl;
+
+        passed = passed && !regressed;
+      }
+    }
+
+    std::cout << std::defaultfloat;
+
+    return passed;
+  }
+
+  const char* PlaybackBenchmark::modeName( visimpl::tVisualMode mode )
+  {
+    switch( mode )
+    {
+      case visimpl::TMODE_SELECTION:
+        return "selection";
+      case visimpl::TMODE_GROUPS:
+        return "groups";
+      case visimpl::TMODE_ATTRIBUTE:
+        return "attribute";
+      default:
+        return "undefined";
+    }
+  }
+
+  const char* PlaybackBenchmark::stageName( TStage stage )
+  {
+    switch( stage )
+    {
+      case TSTAGE_FRAME:
+        return "frame";
+      case TSTAGE_INPUT:
+        return "input";
+      case TSTAGE_UPDATE:
+        return "update";
+      case TSTAGE_TOTAL:
+        return "total";
+      default:
+        return "undefined";
+    }
+  }
+
+}
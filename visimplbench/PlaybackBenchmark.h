@@ -0,0 +1,128 @@
+/*
+ * @file  PlaybackBenchmark.h
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+#ifndef __VISIMPLBENCH_PLAYBACKBENCHMARK__
+#define __VISIMPLBENCH_PLAYBACKBENCHMARK__
+
+#include <string>
+#include <vector>
+
+#include <QJsonObject>
+
+#include <prefr/prefr.h>
+#include <simil/simil.h>
+
+#include "../visimpl/DomainManager.h"
+
+namespace visimplbench
+{
+  typedef enum
+  {
+    TSTAGE_FRAME = 0,
+    TSTAGE_INPUT,
+    TSTAGE_UPDATE,
+    TSTAGE_TOTAL,
+    TSTAGE_NUMBER
+  } TStage;
+
+  struct BenchmarkConfig
+  {
+    BenchmarkConfig( void );
+
+    std::string networkFile;
+    std::string activityFile;
+    simil::TDataType dataType;
+
+    unsigned int frames;
+    unsigned int warmupFrames;
+
+    // Simulation time advanced by every player frame.
+    float deltaTime;
+    // Fixed delta time handed to the particle updaters.
+    float updateDelta;
+    float decay;
+    // Transfer function table entries, 0 for exact curves.
+    unsigned int lutSize;
+    // Particle update threads, 0 for every hardware thread.
+    unsigned int threads;
+
+    // Gids are split into this many visual groups, the first one is also
+    // the selection.
+    unsigned int groups;
+
+    std::vector< visimpl::tVisualMode > modes;
+
+    std::string outputFile;
+    std::string baselineFile;
+    // Allowed p95 increase over the baseline, as a fraction.
+    float tolerance;
+  };
+
+  struct StageStatistics
+  {
+    double mean;
+    double p50;
+    double p95;
+    double p99;
+  };
+
+  struct ModeResult
+  {
+    visimpl::tVisualMode mode;
+    StageStatistics stages[ TSTAGE_NUMBER ];
+    double spikesPerFrame;
+  };
+
+  /*
+   * Drives the playback pipeline without a window nor a GL context: the
+   * SimIL player steps with a fixed delta time, spikes go through
+   * DomainManager::processInput in every requested visual mode and the
+   * particle updaters run with a fixed delta time. Every stage is timed per
+   * frame and summarized as mean and p50/p95/p99 costs in microseconds.
+   * Results can be written as JSON and compared against a previous run.
+   */
+  class PlaybackBenchmark
+  {
+  public:
+
+    PlaybackBenchmark( const BenchmarkConfig& config );
+    ~PlaybackBenchmark( void );
+
+    bool load( void );
+    void run( void );
+
+    void report( void ) const;
+    bool write( void ) const;
+
+    // Returns false when any stage p95 regressed over the tolerance.
+    bool compare( void ) const;
+
+    static const char* modeName( visimpl::tVisualMode mode );
+    static const char* stageName( TStage stage );
+
+  protected:
+
+    ModeResult _runMode( visimpl::tVisualMode mode );
+
+    QJsonObject _toJson( void ) const;
+
+    static StageStatistics _statistics( std::vector< double >& samples );
+
+    BenchmarkConfig _config;
+
+    simil::SpikesPlayer* _player;
+    visimpl::TSpikeTimeIndexPtr _spikeIndex;
+    prefr::ParticleSystem* _particleSystem;
+    visimpl::DomainManager* _domainManager;
+
+    std::vector< ModeResult > _results;
+  };
+
+}
+
+#endif /* __VISIMPLBENCH_PLAYBACKBENCHMARK__ */
@@ -0,0 +1,250 @@
+/*
+ * @file  visimplbench.cpp
+ * @brief
+ * @author Sergio E. Galindo <sergio.galindo@urjc.es>
+ * @date
+ * @remarks Copyright (c) GMRV/URJC. All rights reserved.
+ *          Do not distribute without further notice.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <QCoreApplication>
+
+#include "PlaybackBenchmark.h"
+#include "KernelBenchmark.h"
+
+void usageMessage( char* progName );
+
+int main( int argc, char** argv )
+{
+  // No window nor GL context, just the event loop free core application.
+  QCoreApplication application( argc, argv );
+
+  visimplbench::BenchmarkConfig config;
+  bool modesGiven = false;
+  size_t kernelParticles = 0;
+
+  for( int i = 1; i < argc; i++ )
+  {
+    if ( std::strcmp( argv[i], "--help" ) == 0 ||
+         std::strcmp( argv[i], "-h" ) == 0 )
+    {
+      usageMessage( argv[0] );
+      return 0;
+    }
+    else if( std::strcmp( argv[ i ], "-csv" ) == 0 )
+    {
+      if( i + 2 < argc )
+      {
+        config.dataType = simil::TCSV;
+        config.networkFile = argv[ ++i ];
+        config.activityFile = argv[ ++i ];
+      }
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-h5" ) == 0 )
+    {
+      if( i + 2 < argc )
+      {
+        config.dataType = simil::THDF5;
+        config.networkFile = argv[ ++i ];
+        config.activityFile = argv[ ++i ];
+      }
+      else
+        usageMessage( argv[0] );
+    }
+#ifdef SIMIL_USE_BRION
+    else if( std::strcmp( argv[ i ], "-bc" ) == 0 )
+    {
+      if( ++i < argc )
+      {
+        config.dataType = simil::TBlueConfig;
+        config.networkFile = argv[ i ];
+      }
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-r" ) == 0 )
+    {
+      if( ++i < argc )
+        config.activityFile = argv[ i ];
+      else
+        usageMessage( argv[0] );
+    }
+#endif
+    else if( std::strcmp( argv[ i ], "-frames" ) == 0 )
+    {
+      if( ++i < argc )
+        config.frames = std::strtoul( argv[ i ], nullptr, 10 );
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-warmup" ) == 0 )
+    {
+      if( ++i < argc )
+        config.warmupFrames = std::strtoul( argv[ i ], nullptr, 10 );
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-delta" ) == 0 )
+    {
+      if( ++i < argc )
+        config.deltaTime = std::atof( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-update" ) == 0 )
+    {
+      if( ++i < argc )
+        config.updateDelta = std::atof( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-decay" ) == 0 )
+    {
+      if( ++i < argc )
+        config.decay = std::atof( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-lut" ) == 0 )
+    {
+      if( ++i < argc )
+        config.lutSize = std::atoi( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-threads" ) == 0 )
+    {
+      if( ++i < argc )
+        config.threads = std::atoi( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-groups" ) == 0 )
+    {
+      if( ++i < argc )
+        config.groups = std::atoi( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-mode" ) == 0 )
+    {
+      if( ++i >= argc )
+        usageMessage( argv[0] );
+
+      if( !modesGiven )
+        config.modes.clear( );
+      modesGiven = true;
+
+      if( std::strcmp( argv[ i ], "selection" ) == 0 )
+        config.modes.push_back( visimpl::TMODE_SELECTION );
+      else if( std::strcmp( argv[ i ], "groups" ) == 0 )
+        config.modes.push_back( visimpl::TMODE_GROUPS );
+      else if( std::strcmp( argv[ i ], "attribute" ) == 0 )
+        config.modes.push_back( visimpl::TMODE_ATTRIBUTE );
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-kernel" ) == 0 )
+    {
+      if( ++i < argc )
+        kernelParticles = std::strtoull( argv[ i ], nullptr, 10 );
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-o" ) == 0 )
+    {
+      if( ++i < argc )
+        config.outputFile = argv[ i ];
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-baseline" ) == 0 )
+    {
+      if( ++i < argc )
+        config.baselineFile = argv[ i ];
+      else
+        usageMessage( argv[0] );
+    }
+    else if( std::strcmp( argv[ i ], "-tolerance" ) == 0 )
+    {
+      if( ++i < argc )
+        config.tolerance = std::atof( argv[ i ]);
+      else
+        usageMessage( argv[0] );
+    }
+    else
+    {
+      std::cerr << "Unknown option " << argv[ i ] << std::endl;
+      usageMessage( argv[0] );
+    }
+  }
+
+  // Kernel micro benchmarks need no dataset.
+  if( kernelParticles > 0 )
+    return visimplbench::benchmarkParticleUpdate( kernelParticles,
+                                                  config.frames ) ? 0 : 1;
+
+  if( config.networkFile.empty( ) || config.frames == 0 ||
+      config.deltaTime <= 0.0f )
+    usageMessage( argv[0] );
+
+  visimplbench::PlaybackBenchmark benchmark( config );
+
+  if( !benchmark.load( ))
+    return -1;
+
+  benchmark.run( );
+  benchmark.report( );
+
+  if( !benchmark.write( ))
+    return -1;
+
+  // Regressions over the baseline are reported through the exit code.
+  return benchmark.compare( ) ? 0 : 1;
+}
+
+void usageMessage( char* progName )
+{
+  std::cerr << std::endl
+            << "Usage: "
+            << progName << std::endl
+            << "\t-csv <network_file> <activity_file>"
+            << " | -h5 <network_file> <activity_file>"
+#ifdef SIMIL_USE_BRION
+            << " | -bc <blue_config> [ -r <report_label> ]"
+#endif
+            << std::endl
+            << "\t[ -frames <frames> ]"
+            << std::endl
+            << "\t[ -warmup <frames> ]"
+            << std::endl
+            << "\t[ -delta <simulation_delta_time> ]"
+            << std::endl
+            << "\t[ -update <particle_update_delta_time> ]"
+            << std::endl
+            << "\t[ -decay <decay_time> ]"
+            << std::endl
+            << "\t[ -lut <transfer_function_entries> ]"
+            << std::endl
+            << "\t[ -threads <particle_update_threads> ]"
+            << std::endl
+            << "\t[ -groups <groups> ]"
+            << std::endl
+            << "\t[ -mode selection | groups | attribute ]..."
+            << std::endl
+            << "\t[ -kernel <particles> ]"
+            << std::endl
+            << "\t[ -o <output_json> ]"
+            << std::endl
+            << "\t[ -baseline <baseline_json> [ -tolerance <fraction> ]]"
+            << std::endl
+            << "\t[ --help | -h ]"
+            << std::endl << std::endl;
+  exit(-1);
+}